@@ -0,0 +1,193 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#include "Calculus/compactcurve.h"
+
+CompactCurve::CompactCurve(double gridOrigin, double gridStep, double ordinatesOrigin)
+{
+    xOrigin = gridOrigin;
+    xStep = gridStep;
+    yOrigin = ordinatesOrigin;
+    explicitAbscissas = false;
+}
+
+CompactCurve::CompactCurve(const QList<QPolygonF> &parts, double gridOrigin, double gridStep, double ordinatesOrigin)
+    : CompactCurve(gridOrigin, gridStep, ordinatesOrigin)
+{
+    for(const QPolygonF &part : parts)
+        addSegment(part);
+
+    squeeze();
+}
+
+bool CompactCurve::gridIndex(double abscissa, int &index) const
+{
+    double pos = (abscissa - xOrigin) / xStep;
+
+    if(!(fabs(pos) < std::numeric_limits<int>::max()))
+        return false;
+
+    index = qRound(pos);
+    return fabs(pos - index) <= GRID_TOLERANCE;
+}
+
+void CompactCurve::addSegment(const QPolygonF &segment)
+{
+    if(segment.isEmpty())
+        return;
+
+    CurveSegment seg;
+    seg.offset = y.size();
+    seg.size = segment.size();
+    seg.gridStart = 0;
+    seg.headX = seg.tailX = nan("");
+
+    if(!explicitAbscissas)
+    {
+        // the segment fits the grid when all its points but its two ends are consecutive grid samples
+
+        int first = 0, last = segment.size() - 1, index = 0;
+        bool fits = true;
+
+        if(!gridIndex(segment.first().x(), index))
+        {
+            seg.headX = segment.first().x();
+            first++;
+        }
+        if(last >= first && !gridIndex(segment.last().x(), index))
+        {
+            seg.tailX = segment.last().x();
+            last--;
+        }
+
+        if(first <= last)
+        {
+            fits = gridIndex(segment[first].x(), seg.gridStart);
+
+            for(int i = first + 1 ; i <= last && fits ; i++)
+                fits = gridIndex(segment[i].x(), index) && index == seg.gridStart + i - first;
+        }
+
+        if(!fits)
+        {
+            switchToExplicitAbscissas();
+            seg.headX = seg.tailX = nan("");
+        }
+    }
+
+    if(explicitAbscissas)
+        for(const QPointF &pt : segment)
+            x << float(pt.x() - xOrigin);
+
+    for(const QPointF &pt : segment)
+        y << float(qBound(-MAX_STORED_ORDINATE, pt.y() - yOrigin, MAX_STORED_ORDINATE));
+
+    segments << seg;
+}
+
+void CompactCurve::switchToExplicitAbscissas()
+{
+    x.reserve(y.capacity());
+
+    for(int i = 0 ; i < segments.size() ; i++)
+    {
+        for(int j = 0 ; j < segments[i].size ; j++)
+            x << float(pointAbscissa(segments[i], j) - xOrigin);
+
+        segments[i].headX = segments[i].tailX = nan("");
+    }
+
+    explicitAbscissas = true;
+}
+
+double CompactCurve::pointAbscissa(const CurveSegment &segment, int i) const
+{
+    if(explicitAbscissas)
+        return xOrigin + double(x[segment.offset + i]);
+
+    bool hasHead = !std::isnan(segment.headX);
+
+    if(i == 0 && hasHead)
+        return segment.headX;
+    else if(i == segment.size - 1 && !std::isnan(segment.tailX))
+        return segment.tailX;
+    else return xOrigin + (segment.gridStart + i - (hasHead ? 1 : 0)) * xStep;
+}
+
+void CompactCurve::squeeze()
+{
+    y.squeeze();
+    x.squeeze();
+    segments.squeeze();
+}
+
+QList<QPolygonF> CompactCurve::toPolygons() const
+{
+    QList<QPolygonF> parts;
+    QPolygonF part;
+
+    for(int i = 0 ; i < segments.size() ; i++)
+    {
+        getSegment(i, part);
+        parts << part;
+    }
+
+    return parts;
+}
+
+int CompactCurve::getSegmentsNum() const
+{
+    return segments.size();
+}
+
+void CompactCurve::getSegment(int index, QPolygonF &part) const
+{
+    // part is resized in place, a buffer reused from one segment to the next is not reallocated
+
+    const CurveSegment &segment = segments[index];
+
+    part.resize(segment.size);
+
+    for(int i = 0 ; i < segment.size ; i++)
+        part[i] = QPointF(pointAbscissa(segment, i), yOrigin + double(y[segment.offset + i]));
+}
+
+double CompactCurve::getGridOrigin() const
+{
+    return xOrigin;
+}
+
+int CompactCurve::getPointsNum() const
+{
+    return y.size();
+}
+
+bool CompactCurve::isEmpty() const
+{
+    return segments.isEmpty();
+}
+
+qint64 CompactCurve::getMemoryUsage() const
+{
+    return sizeof(CompactCurve) + qint64(y.capacity()) * sizeof(float) + qint64(x.capacity()) * sizeof(float) +
+            qint64(segments.capacity()) * sizeof(CurveSegment);
+}
@@ -0,0 +1,72 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#ifndef COMPACTCURVE_H
+#define COMPACTCURVE_H
+
+#include <QtWidgets>
+
+#define GRID_TOLERANCE 1E-6 // in sampling steps, how far a sample may be from the grid and still be considered on it
+#define MAX_STORED_ORDINATE 1E30 // relative ordinates are clamped to this so that they stay finite as floats
+
+struct CurveSegment
+{
+    int offset, size; // location of the segment's points in the ordinates array
+    int gridStart; // grid index of the first point that lies on the sampling grid
+    double headX, tailX; // exact abscissas of break points lying off the grid, nan when the end is on the grid
+};
+
+class CompactCurve
+{
+    // Stores a curve made of several polylines sampled on a regular grid of abscissas:
+    // the ordinates are kept as floats relative to yOrigin and the abscissas are implicit,
+    // only the break points found between two grid samples keep their exact abscissa.
+    // Segments that do not fit the grid make the whole curve fall back to a float abscissas array.
+
+public:
+    CompactCurve(double gridOrigin = 0, double gridStep = 1, double ordinatesOrigin = 0);
+    CompactCurve(const QList<QPolygonF> &parts, double gridOrigin, double gridStep, double ordinatesOrigin);
+
+    void addSegment(const QPolygonF &segment);
+    void squeeze();
+
+    QList<QPolygonF> toPolygons() const;
+    int getSegmentsNum() const;
+    void getSegment(int index, QPolygonF &part) const;
+    double getGridOrigin() const;
+    int getPointsNum() const;
+    bool isEmpty() const;
+    qint64 getMemoryUsage() const;
+
+protected:
+    bool gridIndex(double x, int &index) const;
+    double pointAbscissa(const CurveSegment &segment, int i) const;
+    void switchToExplicitAbscissas();
+
+    double xOrigin, xStep, yOrigin;
+    QVector<float> y;
+    QVector<float> x; // relative to xOrigin, only filled once the curve fell back to explicit abscissas
+    bool explicitAbscissas;
+    QVector<CurveSegment> segments;
+};
+
+#endif // COMPACTCURVE_H
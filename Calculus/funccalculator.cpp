@@ -55,6 +55,10 @@ void FuncCalculator::setColorSaver(ColorSaver *colsaver)
 
 void FuncCalculator::setIntegrationPointsList(QList<Point> list)
 {
+    // read by the background samplers while they evaluate the trees
+    QWriteLocker locker(getTreesLock());
+    treesRevisionCounter().ref();
+
     integrationPoints = list;
 }
 
@@ -77,10 +81,32 @@ bool FuncCalculator::getDrawState()
     return drawState && isFuncValid();
 }
 
+QReadWriteLock* FuncCalculator::getTreesLock()
+{
+    // held for reading by the background samplers, and for writing whenever a tree gets replaced
+    static QReadWriteLock treesLock;
+    return &treesLock;
+}
+
+QAtomicInt& FuncCalculator::treesRevisionCounter()
+{
+    static QAtomicInt treesRevision;
+    return treesRevision;
+}
+
+int FuncCalculator::getTreesRevision()
+{
+    // bumped whenever a tree gets replaced, so batches prepared from the old trees can be told apart
+    return treesRevisionCounter().load();
+}
+
 bool FuncCalculator::validateExpression(QString expr)
 {
     if(expression != expr)
     {
+        QWriteLocker locker(getTreesLock());
+        treesRevisionCounter().ref();
+
         if(funcTree != nullptr)
             treeCreator.deleteFastTree(funcTree);
 
@@ -168,8 +194,7 @@ double FuncCalculator::getAntiderivativeValue(double b, Point A, double k_val)
 
 double FuncCalculator::getFuncValue(double x, double kValue)
 {
-    k = kValue;
-    return calculateFromTree(funcTree, x);
+    return calculateFromTree(funcTree, x, kValue);
 }
 
 void FuncCalculator::setDrawState(bool draw)
@@ -179,13 +204,12 @@ void FuncCalculator::setDrawState(bool draw)
 
 double FuncCalculator::getDerivativeValue(double x, double k_val)
 {
-    k = k_val;
     double y1, y2, y3, y4, a;
 
-    y1 = getFuncValue(x - 2*EPSILON, k);
-    y2 = 8*getFuncValue(x - EPSILON, k);
-    y3 = 8*getFuncValue(x + EPSILON, k);
-    y4 = getFuncValue(x + 2*EPSILON, k);
+    y1 = getFuncValue(x - 2*EPSILON, k_val);
+    y2 = 8*getFuncValue(x - EPSILON, k_val);
+    y3 = 8*getFuncValue(x + EPSILON, k_val);
+    y4 = getFuncValue(x + 2*EPSILON, k_val);
     a = (y1 - y2 + y3 - y4)/(12*EPSILON);
 
     return a;
@@ -263,7 +287,7 @@ bool FuncCalculator::canBeCalled()
     return isExprValidated && areIntegrationPointsGood && areCalledFuncsGood && !callLock;
 }
 
-double FuncCalculator::calculateFromTree(FastTree *tree, double x)
+double FuncCalculator::calculateFromTree(FastTree *tree, double x, double k)
 {
     if(tree->type == NUMBER )
     {
@@ -279,49 +303,194 @@ double FuncCalculator::calculateFromTree(FastTree *tree, double x)
     }
     else if(tree->type == PLUS)
     {
-        return calculateFromTree(tree->left, x) + calculateFromTree(tree->right, x);
+        return calculateFromTree(tree->left, x, k) + calculateFromTree(tree->right, x, k);
     }
     else if(tree->type == MINUS)
     {
-        return calculateFromTree(tree->left, x) - calculateFromTree(tree->right, x);
+        return calculateFromTree(tree->left, x, k) - calculateFromTree(tree->right, x, k);
     }
     else if(tree->type == MULTIPLY)
     {
-        return calculateFromTree(tree->left, x) * calculateFromTree(tree->right, x);
+        return calculateFromTree(tree->left, x, k) * calculateFromTree(tree->right, x, k);
     }
     else if(tree->type == DIVIDE)
     {
-        return calculateFromTree(tree->left, x) / calculateFromTree(tree->right, x);
+        return calculateFromTree(tree->left, x, k) / calculateFromTree(tree->right, x, k);
     }
     else if(tree->type == POW)
     {
-        return pow(calculateFromTree(tree->left, x), calculateFromTree(tree->right, x));
+        return pow(calculateFromTree(tree->left, x, k), calculateFromTree(tree->right, x, k));
     }
     else if(REF_FUNC_START < tree->type && tree->type < REF_FUNC_END)
     {
-        return (*refFuncs[tree->type - REF_FUNC_START - 1])(calculateFromTree(tree->right, x));
+        return (*refFuncs[tree->type - REF_FUNC_START - 1])(calculateFromTree(tree->right, x, k));
     }
     else if(FUNC_START < tree->type && tree->type < FUNC_END)
     {
         int id = tree->type - FUNC_START - 1;
-        return funcCalculatorsList[id]->getFuncValue(calculateFromTree(tree->right, x), k);
+        return funcCalculatorsList[id]->getFuncValue(calculateFromTree(tree->right, x, k), k);
     }
     else if(DERIV_START < tree->type && tree->type < DERIV_END)
     {
         int id = tree->type - DERIV_START - 1;
-        return funcCalculatorsList[id]->getDerivativeValue(calculateFromTree(tree->right, x), k);
+        return funcCalculatorsList[id]->getDerivativeValue(calculateFromTree(tree->right, x, k), k);
     }
     else if(INTEGRATION_FUNC_START < tree->type && tree->type < INTEGRATION_FUNC_END)
     {
         int id = tree->type - INTEGRATION_FUNC_START - 1;
-        return funcCalculatorsList[id]->getAntiderivativeValue(calculateFromTree(tree->right, x), integrationPoints[id], k);
+        return funcCalculatorsList[id]->getAntiderivativeValue(calculateFromTree(tree->right, x, k), integrationPoints[id], k);
     }
 
     else return nan("");
 }
 
+bool FuncCalculator::dependsOnX(FastTree *tree)
+{
+    if(tree == nullptr)
+        return false;
+    else if(tree->type == VAR_X || tree->type == VAR_T)
+        return true;
+    else return dependsOnX(tree->left) || dependsOnX(tree->right);
+}
+
+int FuncCalculator::treeDepth(FastTree *tree)
+{
+    if(tree == nullptr)
+        return 0;
+    else return 1 + std::max(treeDepth(tree->left), treeDepth(tree->right));
+}
+
+void FuncCalculator::addToPrologue(FastTree *tree, FuncBatch &batch)
+{
+    if(tree == nullptr || tree->type == NUMBER || tree->type == PAR_K)
+        return;
+
+    if(dependsOnX(tree))
+    {
+        addToPrologue(tree->left, batch);
+        addToPrologue(tree->right, batch);
+    }
+    else
+    {
+        QVector<double> values(batch.kValues.size());
+
+        for(int i = 0 ; i < values.size() ; i++)
+            values[i] = calculateFromTree(tree, 0, batch.kValues[i]);
+
+        batch.kPrologue.insert(tree, values);
+    }
+}
+
+void FuncCalculator::prepareBatch(FuncBatch &batch, const QVector<double> &kValues)
+{
+    // to be called with the trees lock held, like getFuncValues()
+
+    batch.kValues = kValues;
+    batch.kPrologue.clear();
+    batch.treesRevision = getTreesRevision();
+    batch.scratch.resize(treeDepth(funcTree) * kValues.size());
+
+    addToPrologue(funcTree, batch);
+}
+
+void FuncCalculator::getFuncValues(double x, FuncBatch &batch, double *results)
+{
+    calculateFromTree(funcTree, x, batch, results, 0);
+}
+
+void FuncCalculator::calculateFromTree(FastTree *tree, double x, FuncBatch &batch, double *results, int depth)
+{
+    // the right operand of a node at a given depth is kept in the scratch row of that depth,
+    // its own children only use the rows below so nothing gets overwritten
+
+    const int lanes = batch.kValues.size();
+    const double *kValues = batch.kValues.constData();
+
+    auto prologue = batch.kPrologue.constFind(tree);
+
+    if(prologue != batch.kPrologue.constEnd())
+    {
+        std::copy(prologue->constBegin(), prologue->constEnd(), results);
+    }
+    else if(tree->type == NUMBER)
+    {
+        std::fill(results, results + lanes, *tree->value);
+    }
+    else if(tree->type == VAR_X || tree->type == VAR_T)
+    {
+        std::fill(results, results + lanes, x);
+    }
+    else if(tree->type == PAR_K)
+    {
+        std::copy(kValues, kValues + lanes, results);
+    }
+    else if(tree->type == PLUS || tree->type == MINUS || tree->type == MULTIPLY || tree->type == DIVIDE || tree->type == POW)
+    {
+        double *right = batch.scratch.data() + depth * lanes;
+
+        calculateFromTree(tree->left, x, batch, results, depth + 1);
+        calculateFromTree(tree->right, x, batch, right, depth + 1);
+
+        if(tree->type == PLUS)
+            for(int i = 0 ; i < lanes ; i++)
+                results[i] += right[i];
+        else if(tree->type == MINUS)
+            for(int i = 0 ; i < lanes ; i++)
+                results[i] -= right[i];
+        else if(tree->type == MULTIPLY)
+            for(int i = 0 ; i < lanes ; i++)
+                results[i] *= right[i];
+        else if(tree->type == DIVIDE)
+            for(int i = 0 ; i < lanes ; i++)
+                results[i] /= right[i];
+        else
+            for(int i = 0 ; i < lanes ; i++)
+                results[i] = pow(results[i], right[i]);
+    }
+    else if(REF_FUNC_START < tree->type && tree->type < REF_FUNC_END)
+    {
+        double (*refFunc)(double) = refFuncs[tree->type - REF_FUNC_START - 1];
+
+        calculateFromTree(tree->right, x, batch, results, depth + 1);
+
+        for(int i = 0 ; i < lanes ; i++)
+            results[i] = (*refFunc)(results[i]);
+    }
+    else if(FUNC_START < tree->type && tree->type < FUNC_END)
+    {
+        FuncCalculator *func = funcCalculatorsList[tree->type - FUNC_START - 1];
+
+        calculateFromTree(tree->right, x, batch, results, depth + 1);
+
+        for(int i = 0 ; i < lanes ; i++)
+            results[i] = func->getFuncValue(results[i], kValues[i]);
+    }
+    else if(DERIV_START < tree->type && tree->type < DERIV_END)
+    {
+        FuncCalculator *func = funcCalculatorsList[tree->type - DERIV_START - 1];
+
+        calculateFromTree(tree->right, x, batch, results, depth + 1);
+
+        for(int i = 0 ; i < lanes ; i++)
+            results[i] = func->getDerivativeValue(results[i], kValues[i]);
+    }
+    else if(INTEGRATION_FUNC_START < tree->type && tree->type < INTEGRATION_FUNC_END)
+    {
+        int id = tree->type - INTEGRATION_FUNC_START - 1;
+
+        calculateFromTree(tree->right, x, batch, results, depth + 1);
+
+        for(int i = 0 ; i < lanes ; i++)
+            results[i] = funcCalculatorsList[id]->getAntiderivativeValue(results[i], integrationPoints[id], kValues[i]);
+    }
+    else std::fill(results, results + lanes, nan(""));
+}
+
 FuncCalculator::~FuncCalculator()
 {
+    QWriteLocker locker(getTreesLock());
+    treesRevisionCounter().ref();
+
     if(funcTree != nullptr)
         treeCreator.deleteFastTree(funcTree);
 }
@@ -27,6 +27,17 @@
 #include "treecreator.h"
 #include "colorsaver.h"
 
+struct FuncBatch
+{
+    // evaluation of a function for a set of k values at once: every tree node is computed
+    // for all the k values in a row, each lane of the contiguous arrays holding one k value
+
+    QVector<double> kValues;
+    QHash<const FastTree*, QVector<double>> kPrologue; // subtrees that do not depend on x, computed once per k
+    QVector<double> scratch;
+    int treesRevision;
+};
+
 class FuncCalculator : public QObject
 {
     Q_OBJECT
@@ -50,6 +61,8 @@ public:
 
     double getAntiderivativeValue(double b, Point A, double k_val = 0);
     double getFuncValue(double x, double kValue = 0);
+    void prepareBatch(FuncBatch &batch, const QVector<double> &kValues);
+    void getFuncValues(double x, FuncBatch &batch, double *results);
     double getDerivativeValue(double x, double k_val = 0);
 
 
@@ -61,15 +74,22 @@ public:
 
     Range getParametricRange();
 
+    static QReadWriteLock* getTreesLock();
+    static int getTreesRevision();
+
 public slots:
     void setDrawState(bool draw);
 
 protected:
-    double calculateFromTree(FastTree *tree, double x);
+    double calculateFromTree(FastTree *tree, double x, double k);
+    void calculateFromTree(FastTree *tree, double x, FuncBatch &batch, double *results, int depth);
+    void addToPrologue(FastTree *tree, FuncBatch &batch);
+    bool dependsOnX(FastTree *tree);
+    int treeDepth(FastTree *tree);
+    static QAtomicInt& treesRevisionCounter();
     void addRefFuncsPointers();
 
     int funcNum;
-    double k;
     bool isExprValidated, isParametric, areCalledFuncsGood, areIntegrationPointsGood, drawState, callLock;
     TreeCreator treeCreator;
     FastTree *funcTree;
@@ -25,10 +25,69 @@
 FuncValuesSaver::FuncValuesSaver(QList<FuncCalculator*> funcsList, double pxStep)
 {    
     funcs = funcsList;
+    refinementPending = false;
     setPixelStep(pxStep);
 
+    QSettings settings;
+    setMemoryBudget(settings.value("graph/curves/memory_budget_mb", CURVES_MEMORY_BUDGET_MB).toLongLong() * 1024 * 1024);
+
     for(short i = 0 ; i < funcs.size() ; i++)
-        funcCurves << QList<QList<QPolygonF>>();
+    {
+        funcCurves << QList<CompactCurve>();
+        funcMemoryUsage << 0;
+        droppedCurves << 0;
+    }
+}
+
+void FuncValuesSaver::setMemoryBudget(qint64 bytes)
+{
+    // enforced whenever curves are stored, the curves of a family that do not fit are not kept
+    memoryBudget = bytes;
+}
+
+qint64 FuncValuesSaver::getMemoryUsage()
+{
+    qint64 usage = 0;
+
+    for(qint64 funcUsage : funcMemoryUsage)
+        usage += funcUsage;
+
+    return usage;
+}
+
+int FuncValuesSaver::getDroppedCurvesNum()
+{
+    int dropped = 0;
+
+    for(int funcDropped : droppedCurves)
+        dropped += funcDropped;
+
+    return dropped;
+}
+
+void FuncValuesSaver::storeCurves(int func, QList<CompactCurve> curves)
+{
+    qint64 available = memoryBudget - getMemoryUsage() + funcMemoryUsage[func];
+    qint64 used = 0, curveUsage = 0;
+
+    funcCurves[func].clear();
+
+    for(const CompactCurve &curve : curves)
+    {
+        curveUsage = curve.getMemoryUsage();
+
+        if(used + curveUsage > available)
+            break;
+
+        funcCurves[func] << curve;
+        used += curveUsage;
+    }
+
+    funcMemoryUsage[func] = used;
+    droppedCurves[func] = curves.size() - funcCurves[func].size();
+
+    if(droppedCurves[func] > 0)
+        emit curvesDropped(getDroppedCurvesNum());
 }
 
 void FuncValuesSaver::setPixelStep(double pxStep)
@@ -41,163 +100,428 @@ double FuncValuesSaver::evalFunc(int funId, double x, double k)
     return funcs[funId]->getFuncValue(x, k);
 }
 
+FuncSampling FuncValuesSaver::getSampling(double pxStep, int bisectionIterations)
+{
+    FuncSampling sampling;
+
+    sampling.xUnit = xUnit;
+    sampling.yUnit = yUnit;
+    sampling.pixelStep = pxStep;
+    sampling.unitStep = pxStep / xUnit;
+    sampling.bisectionIterations = bisectionIterations;
+
+    return sampling;
+}
+
+bool FuncValuesSaver::isDiscontinuous(int funId, double k, QPointF &left, QPointF &right, const FuncSampling &sampling, const ZeGraphView &view)
+{
+    // left and right are consecutive samples in view coordinates. When a break is found, they are
+    // narrowed down to the tightest bracket around it, so they can be used as the exact ends of the two curve parts
+
+    if(fabs(right.y() - left.y()) * sampling.yUnit <= DISCONTINUITY_SUSPECT_SLOPE * sampling.pixelStep)
+        return false;
+
+    QPointF middle;
+    double y;
+
+    for(int i = 0 ; i < sampling.bisectionIterations ; i++)
+    {
+        middle.setX((left.x() + right.x()) / 2);
+        y = evalFunc(funId, view.viewToUnitX(middle.x()), k);
+
+        if(std::isnan(y) || std::isinf(y))
+            return true;
+
+        middle.setY(view.unitToViewY(y));
+
+        // a continuous curve sees the jump of its steepest half shrink at every step, a jump or a pole keeps it
+
+        if(fabs(middle.y() - left.y()) > fabs(right.y() - middle.y()))
+            right = middle;
+        else left = middle;
+
+        if(fabs(right.y() - left.y()) * sampling.yUnit < DISCONTINUITY_PX_THRESHOLD)
+            return false;
+    }
+
+    return true;
+}
+
+void FuncValuesSaver::addSample(CompactCurve &curve, QPolygonF &curvePart, double x, double y, int funId, double k,
+                                const FuncSampling &sampling, const ZeGraphView &view)
+{
+    // x and y are already in view coordinates, a value out of a log axis' domain is a break like any undefined value
+
+    QPointF pt, pt1, pt2;
+
+    if(std::isnan(y) || std::isinf(y))
+    {
+        if(!curvePart.isEmpty())
+        {
+            curve.addSegment(curvePart);
+            curvePart.clear();
+        }
+    }
+    else
+    {
+        pt = QPointF(x, y);
+
+        if(!curvePart.isEmpty())
+        {
+            pt1 = curvePart.last();
+            pt2 = pt;
+
+            if(isDiscontinuous(funId, k, pt1, pt2, sampling, view))
+            {
+                curvePart << pt1;
+                curve.addSegment(curvePart);
+                curvePart.clear();
+                curvePart << pt2;
+            }
+        }
+
+        curvePart << pt;
+    }
+}
+
+SampledCurves FuncValuesSaver::sampleFunction(int funId, FuncSampling sampling, ZeGraphView view, int gen)
+{
+    // may run on a worker thread: only reads the function trees, under the calculators' lock.
+    // An outdated pass stops and returns no curve at all, a part of the curves would replace whole ones
+
+    QList<CompactCurve> curves;
+
+    double k = 0;
+    int k_pos = 0, end=0;
+
+    QPolygonF curvePart;
+
+    double xStart = view.viewRect().left() - sampling.unitStep;
+    double xEnd = view.viewRect().right() + sampling.unitStep;
+
+    Range range = sampling.parametricRange;
+    end = std::min(int(trunc((range.end - range.start)/range.step)) + 1, FUNC_PAR_DRAW_LIMIT);
+    k = range.start;
+
+    if(end > 1)
+        return sampleFamily(funId, sampling, view, gen);
+
+    // samples are evenly spaced in view coordinates, so uniformly in log(x) on a log axis,
+    // and converted from and to units for the whole sweep at once
+
+    int samplesNum = qMax(0, int(floor((xEnd - xStart) / sampling.unitStep)) + 1);
+    QVector<double> xValues(samplesNum), xUnits(samplesNum), yValues(samplesNum);
+
+    for(int i = 0 ; i < samplesNum ; i++)
+        xValues[i] = xStart + i * sampling.unitStep;
+
+    view.viewToUnitX(xValues.constData(), xUnits.data(), samplesNum);
+
+    for(k_pos = 0 ; k_pos < end ; k_pos++)
+    {
+        QReadLocker locker(FuncCalculator::getTreesLock());
+
+        if(generation.load() != gen)
+            return SampledCurves{QList<CompactCurve>(), true};
+
+        curves << CompactCurve(xStart, sampling.unitStep, view.viewRect().center().y());
+        curvePart.clear();
+
+        for(int i = 0 ; i < samplesNum ; i++)
+            yValues[i] = evalFunc(funId, xUnits[i], k);
+
+        view.unitToViewY(yValues.constData(), yValues.data(), samplesNum);
+
+        for(int i = 0 ; i < samplesNum ; i++)
+            addSample(curves[k_pos], curvePart, xValues[i], yValues[i], funId, k, sampling, view);
+
+        curves[k_pos].addSegment(curvePart);
+        curves[k_pos].squeeze();
+        curvePart.clear();
+
+        k += range.step;
+    }
+
+    return SampledCurves{curves, false};
+}
+
+SampledCurves FuncValuesSaver::sampleFamily(int funId, FuncSampling sampling, ZeGraphView view, int gen)
+{
+    // a single x sweep for every k value of the family: the tree is walked once per abscissa,
+    // each node computing all the k lanes at once, and what only depends on k is computed beforehand
+
+    QList<CompactCurve> curves;
+
+    Range range = sampling.parametricRange;
+    int end = std::min(int(trunc((range.end - range.start)/range.step)) + 1, FUNC_PAR_DRAW_LIMIT);
+
+    QVector<double> kValues(end), yValues(end);
+    QVector<QPolygonF> curveParts(end);
+    FuncBatch batch;
+
+    double xStart = view.viewRect().left() - sampling.unitStep;
+    double xEnd = view.viewRect().right() + sampling.unitStep;
+
+    int samplesNum = qMax(0, int(floor((xEnd - xStart) / sampling.unitStep)) + 1);
+    QVector<double> xValues(samplesNum), xUnits(samplesNum);
+
+    for(int i = 0 ; i < samplesNum ; i++)
+        xValues[i] = xStart + i * sampling.unitStep;
+
+    view.viewToUnitX(xValues.constData(), xUnits.data(), samplesNum);
+
+    for(int k_pos = 0 ; k_pos < end ; k_pos++)
+    {
+        kValues[k_pos] = range.start + k_pos * range.step;
+        curves << CompactCurve(xStart, sampling.unitStep, view.viewRect().center().y());
+    }
+
+    {
+        QReadLocker locker(FuncCalculator::getTreesLock());
+        funcs[funId]->prepareBatch(batch, kValues);
+    }
+
+    for(int i = 0 ; i < samplesNum ; i++)
+    {
+        QReadLocker locker(FuncCalculator::getTreesLock());
+
+        // the prologue refers to the trees it was computed from, it is useless once they got replaced
+
+        if(generation.load() != gen || FuncCalculator::getTreesRevision() != batch.treesRevision)
+            return SampledCurves{QList<CompactCurve>(), true};
+
+        funcs[funId]->getFuncValues(xUnits[i], batch, yValues.data());
+        view.unitToViewY(yValues.constData(), yValues.data(), end);
+
+        for(int k_pos = 0 ; k_pos < end ; k_pos++)
+            addSample(curves[k_pos], curveParts[k_pos], xValues[i], yValues[k_pos], funId, kValues[k_pos], sampling, view);
+    }
+
+    for(int k_pos = 0 ; k_pos < end ; k_pos++)
+    {
+        curves[k_pos].addSegment(curveParts[k_pos]);
+        curves[k_pos].squeeze();
+    }
+
+    return SampledCurves{curves, false};
+}
+
+void FuncValuesSaver::cancelRefinement()
+{
+    generation.ref();
+
+    for(int i = abandonedPasses.size() - 1 ; i >= 0 ; i--)
+        if(abandonedPasses[i].isFinished())
+            abandonedPasses.removeAt(i);
+
+    for(auto refinement : refinements)
+    {
+        abandonedPasses << refinement->future();
+        refinement->disconnect(this);
+        refinement->deleteLater();
+    }
+
+    refinements.clear();
+}
 
 void FuncValuesSaver::calculateAll(double new_xUnit, double new_yUnit, ZeGraphView view)
 {
+    cancelRefinement();
+
     graphView = view;
     xUnit = new_xUnit;
     yUnit = new_yUnit;
     unitStep = pixelStep / xUnit;
+    refinementPending = false;
 
-    double x = 0, k = 0, delta1 = 0, delta2 = 0, delta3 = 0, y=0;
-    int k_pos = 0, end=0, n=0;
+    FuncSampling sampling = getSampling(pixelStep, MAX_BISECTION_ITERATIONS);
+    int gen = generation.load();
 
-    Range range;
-    QPolygonF curvePart;
-    QPointF pt1, pt2;
+    for(short i = 0; i < funcs.size(); i++)
+    {
+        if(!funcs[i]->isFuncValid())
+            continue;
 
-    double xStart = graphView.viewRect().left() - unitStep;
-    double xEnd = graphView.viewRect().right() + unitStep;
+        sampling.parametricRange = funcs[i]->getParametricRange();
+        SampledCurves sampled = sampleFunction(i, sampling, graphView, gen);
+
+        if(!sampled.aborted)
+            storeCurves(i, sampled.curves);
+    }
+}
+
+void FuncValuesSaver::calculateProgressively(double new_xUnit, double new_yUnit, ZeGraphView view)
+{
+    // a coarse pass is computed right away, the full resolution one is computed on worker threads
+    // and each function's curves are swapped in as soon as they are ready
+
+    cancelRefinement();
+
+    graphView = view;
+    xUnit = new_xUnit;
+    yUnit = new_yUnit;
+    unitStep = pixelStep / xUnit;
+
+    FuncSampling coarseSampling = getSampling(pixelStep * COARSE_PASS_STEP_FACTOR, COARSE_PASS_BISECTION_ITERATIONS);
+    FuncSampling sampling = getSampling(pixelStep, MAX_BISECTION_ITERATIONS);
+    int gen = generation.load();
 
     for(short i = 0; i < funcs.size(); i++)
     {
         if(!funcs[i]->isFuncValid())
             continue;
 
-        funcCurves[i].clear();
+        coarseSampling.parametricRange = sampling.parametricRange = funcs[i]->getParametricRange();
+        SampledCurves sampled = sampleFunction(i, coarseSampling, graphView, gen);
 
-        range = funcs[i]->getParametricRange();
-        end = trunc((range.end - range.start)/range.step) + 1;
-        k = range.start;
+        if(!sampled.aborted)
+            storeCurves(i, sampled.curves);
 
-        for(k_pos = 0 ; k_pos < end && k_pos < PAR_DRAW_LIMIT ; k_pos++)
-        {            
-            funcCurves[i] << QList<QPolygonF>();
-            curvePart.clear();
+        auto *refinement = new QFutureWatcher<SampledCurves>(this);
+
+        connect(refinement, &QFutureWatcherBase::finished, this, [this, refinement, i, gen]()
+        {
+            refinements.removeOne(refinement);
 
-            for(x = xStart ; x <= xEnd; x += unitStep)
-            {                
-                y = evalFunc(i, view.viewToUnit_x(x), k);
+            if(generation.load() == gen)
+            {
+                refinementPending = !refinements.isEmpty();
 
-                if(std::isnan(y) || std::isinf(y))
+                if(!refinement->result().aborted)
                 {
-                    if(!curvePart.isEmpty())
-                    {
-                        funcCurves[i][k_pos] << curvePart;
-                        curvePart.clear();
-                    }
+                    storeCurves(i, refinement->result().curves);
+                    emit curvesRefined();
                 }
-                else
-                {
-                    curvePart <<  QPointF( x ,  view.unitToView_y(y));
+            }
 
-                    n = curvePart.size();
-                    if(n > 1)
-                        delta3 = fabs(curvePart[n-1].y() - curvePart[n-2].y());
+            refinement->deleteLater();
+        });
 
-                    if(n > 2 && delta2 > 4*delta1 && delta2 > 4*delta3)
-                    {
-                        pt1 = curvePart[n-2];
-                        pt2 = curvePart[n-1];
+        refinement->setFuture(QtConcurrent::run(this, &FuncValuesSaver::sampleFunction, int(i), sampling, graphView, gen));
+        refinements << refinement;
+    }
 
-                        curvePart.removeLast();
-                        curvePart.removeLast();
+    refinementPending = !refinements.isEmpty();
+}
 
-                        funcCurves[i][k_pos] << curvePart;
-                        curvePart.clear();
-                        curvePart << pt1 << pt2;
-                    }
+bool FuncValuesSaver::isRefinementPending()
+{
+    // stays true when a move cancelled the refinement, until the next full pass
+    return refinementPending;
+}
 
-                    delta1 = delta2;
-                    delta2 = delta3;
+void FuncValuesSaver::sampleRange(CompactCurve &curve, int funId, double k, double from, double to,
+                                  const FuncSampling &sampling, const ZeGraphView &view)
+{
+    // samples the curve's grid abscissas lying within [from, to] and appends the parts found there
 
-                }
-            }
+    QPolygonF curvePart;
+    double gridOrigin = curve.getGridOrigin();
+    double x = 0;
 
-            if(!curvePart.isEmpty())
-                funcCurves[i][k_pos] << curvePart;
-            curvePart.clear();
+    for(qint64 n = qint64(ceil((from - gridOrigin) / sampling.unitStep - GRID_TOLERANCE)) ; ; n++)
+    {
+        x = gridOrigin + double(n) * sampling.unitStep;
 
-            k += range.step;           
-        }
+        if(x > to)
+            break;
+
+        addSample(curve, curvePart, x, view.unitToViewY(evalFunc(funId, view.viewToUnitX(x), k)), funId, k, sampling, view);
     }
+
+    curve.addSegment(curvePart);
 }
 
 void FuncValuesSaver::move(ZeGraphView view)
 {
+    cancelRefinement();
+
+    QRectF previousRect = graphView.viewRect();
     graphView = view;
 
-    double x = 0, k = 0, k_step = 0, delta1 = 0, delta2 = 0, delta3 = 0, y=0;
+    FuncSampling sampling = getSampling(pixelStep, MAX_BISECTION_ITERATIONS);
+
+    double x = 0, k = 0, k_step = 0, y=0;
     int k_pos = 0;
 
 
     QPolygonF curvePart;
-    QPointF pt1, pt2;
-    int n = 0;
+    QList<QPolygonF> parts;
+    QPointF pt, pt1, pt2;
+    double gridOrigin = 0;
 
     double xStart = graphView.viewRect().left() - unitStep;
     double xEnd = graphView.viewRect().right() + unitStep;
 
+    // the abscissas already sampled are left alone, only the newly exposed ones can add points to a curve
+    double exposedLeftEnd = qMin(xEnd, previousRect.left() - 1.5 * unitStep);
+    double exposedRightStart = qMax(xStart, previousRect.right() + 1.5 * unitStep);
+
     for(short i = 0 ; i < funcs.size(); i++)
     {
         if(!funcs[i]->isFuncValid())
             continue;
 
-        k_step = funcs[i]->getParametricRange().step;
-        k = funcs[i]->getParametricRange().start;
+        sampling.parametricRange = funcs[i]->getParametricRange();
+        k_step = sampling.parametricRange.step;
+        k = sampling.parametricRange.start;
 
         for(k_pos = 0; k_pos < funcCurves[i].size() ; k_pos++)
         {
-            curvePart = funcCurves[i][k_pos].takeFirst();
-            x = curvePart.first().x() - unitStep;
+            // the stored curve is unpacked, extended and trimmed, then packed again around the new view
 
-            if(x >= xStart)
+            parts = funcCurves[i][k_pos].toPolygons();
+            gridOrigin = funcCurves[i][k_pos].getGridOrigin();
+
+            if(parts.isEmpty())
             {
-                if(curvePart.size() >= 3)
-                {
-                    delta2 = fabs(curvePart[0].y() - curvePart[1].y());
-                    delta1 = fabs(curvePart[1].y() - curvePart[2].y());
-                }
-                else if(curvePart.size() == 2)
-                {
-                    delta2 = fabs(curvePart[0].y() - curvePart[1].y());
-                }
+                funcCurves[i][k_pos] = CompactCurve(gridOrigin, unitStep, graphView.viewRect().center().y());
+                sampleRange(funcCurves[i][k_pos], i, k, xStart, exposedLeftEnd, sampling, graphView);
+                sampleRange(funcCurves[i][k_pos], i, k, exposedRightStart, xEnd, sampling, graphView);
+                funcCurves[i][k_pos].squeeze();
 
+                k += k_step;
+                continue;
+            }
 
+            // the extension restarts from the sampling grid, whether the part ends on it or on a break point
+
+            curvePart = parts.takeFirst();
+            x = gridOrigin + (ceil((curvePart.first().x() - gridOrigin) / unitStep - GRID_TOLERANCE) - 1) * unitStep;
+
+            if(x >= xStart)
+            {
                 while(x >= xStart)
                 {
-                    y = evalFunc(i, view.viewToUnit_x(x), k);
+                    y = evalFunc(i, view.viewToUnitX(x), k);
 
                     if(std::isnan(y) || std::isinf(y))
                     {
                         if(!curvePart.isEmpty())
                         {
-                            funcCurves[i][k_pos].prepend(curvePart);
+                            parts.prepend(curvePart);
                             curvePart.clear();
                         }
                     }
                     else
                     {
-                        curvePart.prepend(QPointF(x ,  view.unitToView_y(y)));
-
-                        n = curvePart.size();
-
-                        if(n > 1)
-                            delta3 = fabs(curvePart[0].y() - curvePart[1].y());
+                        pt = QPointF(x, view.unitToViewY(y));
 
-                        if(n > 2 && delta2 > 4*delta1 && delta2 > 4*delta3)
+                        if(!curvePart.isEmpty())
                         {
-                            pt1 = curvePart.takeFirst();
-                            pt2 = curvePart.takeFirst();
-
-                            funcCurves[i][k_pos].prepend(curvePart);
-                            curvePart.clear();
-                            curvePart << pt1 << pt2;
+                            pt1 = pt;
+                            pt2 = curvePart.first();
+
+                            if(isDiscontinuous(i, k, pt1, pt2, sampling, graphView))
+                            {
+                                curvePart.prepend(pt2);
+                                parts.prepend(curvePart);
+                                curvePart.clear();
+                                curvePart << pt1;
+                            }
                         }
 
-                        delta1 = delta2;
-                        delta2 = delta3;
-
+                        curvePart.prepend(pt);
                     }
 
                     x -= unitStep;
@@ -205,69 +529,67 @@ void FuncValuesSaver::move(ZeGraphView view)
             }
             else
             {
-                while(x < xStart)
+                // break points are not on the sampling grid, so parts are trimmed by abscissa instead of by count
+                while(!curvePart.isEmpty() && curvePart.first().x() < xStart)
                 {
-                    if(curvePart.isEmpty())
-                        curvePart = funcCurves[i][k_pos].takeFirst();
                     curvePart.removeFirst();
-                    x += unitStep;
-                }                                
+                    if(curvePart.isEmpty() && !parts.isEmpty())
+                        curvePart = parts.takeFirst();
+                }
             }
 
             if(!curvePart.isEmpty())
-                funcCurves[i][k_pos].prepend(curvePart);
+                parts.prepend(curvePart);
 
             curvePart.clear();
 
-            curvePart = funcCurves[i][k_pos].takeLast();
+            if(parts.isEmpty())
+            {
+                funcCurves[i][k_pos] = CompactCurve(gridOrigin, unitStep, graphView.viewRect().center().y());
+                sampleRange(funcCurves[i][k_pos], i, k, exposedRightStart, xEnd, sampling, graphView);
+                funcCurves[i][k_pos].squeeze();
+
+                k += k_step;
+                continue;
+            }
+
+            curvePart = parts.takeLast();
 
-            x = curvePart.last().x() + unitStep;
+            x = gridOrigin + (floor((curvePart.last().x() - gridOrigin) / unitStep + GRID_TOLERANCE) + 1) * unitStep;
 
             if(x <= xEnd)
             {
-                n = curvePart.size();
-                if(curvePart.size() >= 3)
-                {
-                    delta2 = fabs(curvePart[n-1].y() - curvePart[n-2].y());
-                    delta1 = fabs(curvePart[n-3].y() - curvePart[n-3].y());
-                }
-                else if(curvePart.size() == 2)
-                {
-                    delta2 = fabs(curvePart[n-1].y() - curvePart[n-2].y());
-                }
-
                 while(x <= xEnd)
                 {
-                    y = evalFunc(i, view.viewToUnit_x(x), k);
+                    y = evalFunc(i, view.viewToUnitX(x), k);
 
                     if(std::isnan(y) || std::isinf(y))
                     {
                         if(!curvePart.isEmpty())
                         {
-                            funcCurves[i][k_pos] << curvePart;
+                            parts << curvePart;
                             curvePart.clear();
                         }
                     }
                     else
                     {
-                        curvePart << QPointF(x ,  view.unitToView_y(y) );
-                        n = curvePart.size();
-
-                        if(n > 1)
-                            delta3 = fabs(curvePart[n-1].y() - curvePart[n-2].y());
+                        pt = QPointF(x, view.unitToViewY(y));
 
-                        if(n > 2 && delta2 > 4*delta1 && delta2 > 4*delta3)
+                        if(!curvePart.isEmpty())
                         {
-                            pt2 = curvePart.takeLast();
-                            pt1 = curvePart.takeLast();
-
-                            funcCurves[i][k_pos] << curvePart;
-                            curvePart.clear();
-                            curvePart << pt1 << pt2;
+                            pt1 = curvePart.last();
+                            pt2 = pt;
+
+                            if(isDiscontinuous(i, k, pt1, pt2, sampling, graphView))
+                            {
+                                curvePart << pt1;
+                                parts << curvePart;
+                                curvePart.clear();
+                                curvePart << pt2;
+                            }
                         }
 
-                        delta1 = delta2;
-                        delta2 = delta3;
+                        curvePart << pt;
                     }
 
                     x += unitStep;
@@ -275,20 +597,23 @@ void FuncValuesSaver::move(ZeGraphView view)
             }
             else
             {
-                while(x > xEnd)
+                while(!curvePart.isEmpty() && curvePart.last().x() > xEnd)
                 {
-                    if(curvePart.isEmpty())
-                        curvePart = funcCurves[i][k_pos].takeLast();
                     curvePart.removeLast();
-                    x -= unitStep;
+                    if(curvePart.isEmpty() && !parts.isEmpty())
+                        curvePart = parts.takeLast();
                 }
             }
 
             if(!curvePart.isEmpty())
-                funcCurves[i][k_pos] << curvePart;
+                parts << curvePart;
+
+            funcCurves[i][k_pos] = CompactCurve(parts, gridOrigin, unitStep, graphView.viewRect().center().y());
 
             k += k_step;
         }
+
+        storeCurves(i, funcCurves[i]);
     }
 }
 
@@ -299,5 +624,20 @@ int FuncValuesSaver::getFuncDrawsNum(int func)
 
 QList<QPolygonF> FuncValuesSaver::getCurve(int func, int curve)
 {
+    return funcCurves[func][curve].toPolygons();
+}
+
+const CompactCurve& FuncValuesSaver::getStoredCurve(int func, int curve)
+{
+    // drawing reads the parts one by one from there, without decoding the whole curve
     return funcCurves[func][curve];
 }
+
+FuncValuesSaver::~FuncValuesSaver()
+{
+    cancelRefinement();
+
+    // outdated passes give up at their next curve, but they still need this object until then
+    for(auto &pass : abandonedPasses)
+        pass.waitForFinished();
+}
@@ -25,28 +25,73 @@
 #ifndef FUNCVALUESSAVER_H
 #define FUNCVALUESSAVER_H
 
+#include <QtConcurrent>
+
 #include "information.h"
+#include "Calculus/compactcurve.h"
+
+#define DISCONTINUITY_SUSPECT_SLOPE 4 // segments steeper than this, in pixels per pixel step, get bisected
+#define DISCONTINUITY_PX_THRESHOLD 1.0 // a bracket whose jump is under this pixel size is continuous
+#define MAX_BISECTION_ITERATIONS 24
+#define COARSE_PASS_STEP_FACTOR 4 // the immediate pass samples this many times less than the refined one
+#define COARSE_PASS_BISECTION_ITERATIONS 6
+#define CURVES_MEMORY_BUDGET_MB 512 // default budget of the stored curves, overridden by the "graph/curves/memory_budget_mb" setting
 
-class FuncValuesSaver
+struct FuncSampling
 {
+    double xUnit, yUnit, pixelStep, unitStep;
+    int bisectionIterations;
+    Range parametricRange; // of the sampled function, read on the UI thread which is the one writing it
+};
+
+struct SampledCurves
+{
+    QList<CompactCurve> curves;
+    bool aborted; // the pass got outdated before the end, curves is empty then
+};
+
+class FuncValuesSaver : public QObject
+{
+    Q_OBJECT
+
 public:
     FuncValuesSaver(QList<FuncCalculator *> funcsList, double pxStep);
+    ~FuncValuesSaver();
 
     void setPixelStep(double pxStep);
     void calculateAll(double new_xUnit, double new_yUnit, ZeGraphView view);
+    void calculateProgressively(double new_xUnit, double new_yUnit, ZeGraphView view);
     void move(ZeGraphView view);
     int getFuncDrawsNum(int func);
+    bool isRefinementPending();
 
-    QList<QPolygonF> getCurve(int func, int curve);
+    void setMemoryBudget(qint64 bytes);
+    qint64 getMemoryUsage();
+    int getDroppedCurvesNum();
 
+    QList<QPolygonF> getCurve(int func, int curve);
+    const CompactCurve& getStoredCurve(int func, int curve);
 
+signals:
+    void curvesRefined();
+    void curvesDropped(int total);
 
 protected slots:
     void recalculateFuncColors(int id);
 
 protected:
     void calculateAllFuncColors();
+    void cancelRefinement();
+    FuncSampling getSampling(double pxStep, int bisectionIterations);
+    SampledCurves sampleFunction(int funId, FuncSampling sampling, ZeGraphView view, int gen);
+    SampledCurves sampleFamily(int funId, FuncSampling sampling, ZeGraphView view, int gen);
+    void storeCurves(int func, QList<CompactCurve> curves);
+    void addSample(CompactCurve &curve, QPolygonF &curvePart, double x, double y, int funId, double k,
+                   const FuncSampling &sampling, const ZeGraphView &view);
+    void sampleRange(CompactCurve &curve, int funId, double k, double from, double to,
+                     const FuncSampling &sampling, const ZeGraphView &view);
     double evalFunc(int funId, double x, double k);
+    bool isDiscontinuous(int funId, double k, QPointF &left, QPointF &right, const FuncSampling &sampling, const ZeGraphView &view);
 
     Information *information;
     ZeGraphView graphView;
@@ -54,7 +99,15 @@ protected:
 
     double xUnit, yUnit, pixelStep, unitStep;
 
-    QList< QList< QList<QPolygonF> > > funcCurves;
+    QAtomicInt generation; // every pass carries the generation it was started in, and gives up once it is outdated
+    bool refinementPending;
+    QList< QFutureWatcher<SampledCurves>* > refinements;
+    QList< QFuture<SampledCurves> > abandonedPasses; // cancelled, possibly still running
+
+    QList< QList<CompactCurve> > funcCurves;
+    QList<qint64> funcMemoryUsage;
+    QList<int> droppedCurves;
+    qint64 memoryBudget;
     QList< QList<QColor> > funcColors;
 };
 
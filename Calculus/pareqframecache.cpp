@@ -0,0 +1,164 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#include "Calculus/pareqframecache.h"
+
+ParEqFrameCache::ParEqFrameCache()
+{
+    useCounter = 0;
+    pointsNum = 0;
+}
+
+QList<Point> ParEqFrameCache::computeFrame(FastTree *xTree, FastTree *yTree, ExprCalculator &calculator, double k, Range tRange,
+                                           const QAtomicInt *generation, int gen)
+{
+    // when a generation is given, the computation gives up as soon as it gets outdated
+
+    QList<Point> frame;
+
+    calculator.setK(k);
+
+    double t = tRange.start;
+    int end = trunc((tRange.end - tRange.start)/tRange.step)+ 1;
+    Point point;
+
+    frame.reserve(end);
+
+    for(int i = 0 ; i < end ; i++)
+    {
+        if(generation != nullptr && generation->load() != gen)
+            return frame;
+
+        point.x = calculator.calculateFromTree(xTree, t);
+        point.y = calculator.calculateFromTree(yTree, t);
+
+        frame << point;
+
+        t += tRange.step;
+    }
+
+    return frame;
+}
+
+bool ParEqFrameCache::getFrame(const ParEqFrameKey &key, QList<Point> &frame)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = frames.find(key);
+    if(it == frames.end())
+        return false;
+
+    it->lastUse = ++useCounter;
+    frame = it->points;
+
+    return true;
+}
+
+void ParEqFrameCache::addFrame(const ParEqFrameKey &key, const QList<Point> &frame)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = frames.find(key);
+    if(it != frames.end())
+        pointsNum -= it->points.size();
+
+    frames[key] = CachedFrame{frame, ++useCounter};
+    pointsNum += frame.size();
+
+    evict();
+}
+
+void ParEqFrameCache::evict()
+{
+    // the most recently used frame is never evicted, so a single oversized frame still gets cached
+    while(pointsNum > KFRAMES_CACHE_POINTS && frames.size() > 1)
+    {
+        auto oldest = frames.begin();
+        for(auto it = frames.begin() ; it != frames.end() ; it++)
+            if(it->lastUse < oldest->lastUse)
+                oldest = it;
+
+        pointsNum -= oldest->points.size();
+        frames.erase(oldest);
+    }
+}
+
+void ParEqFrameCache::prefetch(const ParEqFrameKey &key, FastTree *xTree, FastTree *yTree, QList<FuncCalculator*> funcs, Range tRange)
+{
+    {
+        QMutexLocker locker(&mutex);
+
+        if(frames.contains(key) || pending.contains(key))
+            return;
+
+        pending << key;
+    }
+
+    for(int i = workers.size() - 1 ; i >= 0 ; i--)
+        if(workers[i].isFinished())
+            workers.removeAt(i);
+
+    int gen = generation.load();
+
+    workers << QtConcurrent::run([this, key, xTree, yTree, funcs, tRange, gen]()
+    {
+        if(generation.load() == gen)
+        {
+            QReadLocker treesLocker(FuncCalculator::getTreesLock());
+
+            ExprCalculator calculator(true, funcs);
+            QList<Point> frame = computeFrame(xTree, yTree, calculator, key.k, tRange, &generation, gen);
+
+            if(generation.load() == gen)
+                addFrame(key, frame);
+        }
+
+        QMutexLocker locker(&mutex);
+        pending.remove(key);
+    });
+}
+
+void ParEqFrameCache::cancel()
+{
+    generation.ref();
+
+    for(QFuture<void> &worker : workers)
+        worker.waitForFinished();
+
+    workers.clear();
+}
+
+void ParEqFrameCache::clear()
+{
+    cancel();
+
+    QMutexLocker locker(&mutex);
+
+    frames.clear();
+    pending.clear();
+    pointsNum = 0;
+}
+
+ParEqFrameCache::~ParEqFrameCache()
+{
+    cancel();
+}
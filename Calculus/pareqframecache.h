@@ -0,0 +1,87 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#ifndef PAREQFRAMECACHE_H
+#define PAREQFRAMECACHE_H
+
+#include <QtConcurrent>
+
+#include "structures.h"
+#include "Calculus/exprcalculator.h"
+#include "Calculus/funccalculator.h"
+
+#define KFRAMES_CACHE_POINTS 4000000 // max points kept in the k animation frames cache
+#define KFRAMES_PREFETCH 16 // frames computed ahead of the displayed one
+
+struct ParEqFrameKey
+{
+    uint exprHash;
+    int kPos, treesRevision;
+    double k, tStart, tEnd, tStep;
+
+    bool operator==(const ParEqFrameKey &other) const
+    {
+        return exprHash == other.exprHash && kPos == other.kPos && treesRevision == other.treesRevision &&
+                k == other.k && tStart == other.tStart && tEnd == other.tEnd && tStep == other.tStep;
+    }
+};
+
+inline uint qHash(const ParEqFrameKey &key, uint seed = 0)
+{
+    return qHash(key.exprHash, seed) ^ qHash(key.kPos, seed) ^ qHash(key.k, seed) ^
+            qHash(key.tStart, seed) ^ qHash(key.tStep, seed);
+}
+
+class ParEqFrameCache
+{
+public:
+    ParEqFrameCache();
+    ~ParEqFrameCache();
+
+    static QList<Point> computeFrame(FastTree *xTree, FastTree *yTree, ExprCalculator &calculator, double k, Range tRange,
+                                     const QAtomicInt *generation = nullptr, int gen = 0);
+
+    bool getFrame(const ParEqFrameKey &key, QList<Point> &frame);
+    void addFrame(const ParEqFrameKey &key, const QList<Point> &frame);
+    void prefetch(const ParEqFrameKey &key, FastTree *xTree, FastTree *yTree, QList<FuncCalculator*> funcs, Range tRange);
+    void cancel(); // must be called before the trees given to prefetch() get deleted
+    void clear();
+
+protected:
+    void evict();
+
+    struct CachedFrame
+    {
+        QList<Point> points;
+        quint64 lastUse;
+    };
+
+    QMutex mutex;
+    QHash<ParEqFrameKey, CachedFrame> frames;
+    QSet<ParEqFrameKey> pending;
+    QList< QFuture<void> > workers;
+    QAtomicInt generation;
+    quint64 useCounter;
+    int pointsNum;
+};
+
+#endif // PAREQFRAMECACHE_H
@@ -32,13 +32,12 @@ static double tenPower(double x)
 SeqCalculator::SeqCalculator(int id, QString name, QLabel *errorLabel) : treeCreator(ObjectType::SEQUENCE), firstValsTreeCreator(ObjectType::NORMAL_EXPR)
 {   
     seqNum = id;
-    isExprValidated = isValid = isKRangeValid = blockCalculatingFromTree = false;
+    isExprValidated = isValid = isKRangeValid = blockCalculatingFromTree = checkpointsScheduled = false;
     errorMessageLabel = errorLabel;
 
     areFirstValsValidated = true;    
-    nMin = kPos = 0;
+    nMin = kPos = revision = 0;
     drawsNum = 1;
-    custom_k = 0;
     k = 0;
     drawState = true;
     seqTree = nullptr;
@@ -52,7 +51,11 @@ SeqCalculator::SeqCalculator(int id, QString name, QLabel *errorLabel) : treeCre
 
     seqsNames << "(u<sub>n</sub>)" << "(v<sub>n</sub>)" << "(l<sub>n</sub>)" << "(w<sub>n</sub>)" << "(q<sub>n</sub>)" << "(z<sub>n</sub>)";
 
-    seqValues << QList<double>();
+    terms.setRowsNum(1);
+    currentTerms = &terms;
+    currentWindow = nullptr;
+    currentWindowStart = 0;
+    recurrenceDepth = -2;
 
     seqName =  name;
 }
@@ -61,8 +64,9 @@ bool SeqCalculator::validateFirstValsExpr(QString expr)
 {  
     firstValsExpr = expr;
     areFirstValsValidated = validateSeqFirstValsTrees();
-    seqValues.clear();
+    clearTerms();
     drawsNum = 1;
+    revision++;
 
     if(!areFirstValsValidated)
         errorMessageLabel->setText(tr("NB: First values must be separated by ';'"));
@@ -74,7 +78,8 @@ bool SeqCalculator::validateSeqExpr(QString expr)
 {
     expression = expr;
     drawsNum = 1;
-    seqValues.clear();
+    clearTerms();
+    revision++;
 
     if(seqTree != nullptr)
         treeCreator.deleteFastTree(seqTree);
@@ -94,6 +99,7 @@ void SeqCalculator::setParametricInfo(bool parametric, Range parRange)
     isParametric = parametric;
     kRange = parRange;
     drawsNum = trunc((kRange.end - kRange.start)/kRange.step) + 1;
+    revision++;
 
     isKRangeValid = drawsNum > 0;
 
@@ -106,10 +112,37 @@ int SeqCalculator::getDrawsNum()
     return drawsNum;
 }
 
+int SeqCalculator::getRevision()
+{
+    // changes whenever the terms may have changed, for the caches built from them
+    return revision;
+}
+
+qint64 SeqCalculator::getMemoryUsage()
+{
+    return terms.getMemoryUsage() + customTerms.getMemoryUsage();
+}
+
+void SeqCalculator::clearTerms()
+{
+    // evicted rows keep their first values, they can't be computed from the sequence's expression
+    terms.clear();
+    terms.setPinnedTerms(firstValsTrees.size());
+
+    customTerms.clear();
+    customTerms.setPinnedTerms(firstValsTrees.size());
+    customKs.clear();
+
+    checkpoints.clear();
+    customCheckpoints.clear();
+    recurrenceDepth = -2;
+}
+
 void SeqCalculator::set_nMin(int val)
 {
     nMin = val;
-    seqValues.clear();
+    revision++;
+    clearTerms();
     updateSeqValuesSize();
 }
 
@@ -181,15 +214,21 @@ bool SeqCalculator::checkByCalculatingValues()
     if(!isExprValidated || !areFirstValsValidated)
         return false;
 
-    isValid = saveSeqValues(3*seqValues[0].size() + 10 - nMin);
-    blockCalculatingFromTree = false;
+    double nMax = 3*terms.getSize(0) + 10 - nMin;
+    isValid = true;
+
+    for(int row = 0 ; row < drawsNum && isValid ; row++)
+    {
+        isValid = saveSeqValues(nMax, row);
+        blockCalculatingFromTree = false;
+    }
 
     return isValid;
 }
 
 double SeqCalculator::getCustomSeqValue(double n, bool &ok, double k_value)
 {
-    if( n < nMin || n > MAX_SAVED_SEQ_VALS)
+    if( n < nMin || n-nMin > MAX_FAST_FORWARDED_SEQ_VALS)
         return nan("");
 
     double index = (k_value - kRange.start)/kRange.step;
@@ -197,23 +236,58 @@ double SeqCalculator::getCustomSeqValue(double n, bool &ok, double k_value)
     if(0 <= index && index < drawsNum && index == floor(index))
         return getSeqValue(n, ok, index);
 
-    if(custom_k != k_value)
+    int row = getCustomRow(k_value);
+
+    if(n-nMin > MAX_SAVED_SEQ_VALS)
     {
-        custom_k = k_value;
-        seqValues[drawsNum].clear();
-    }
+        if(customTerms.getSize(row) == 0)
+            ok = saveCustomSeqValues(nMin, row);
 
+        if(!ok)
+            return nan("");
 
-    if(n-nMin >= seqValues[drawsNum].size())
-        ok = saveCustomSeqValues(n);
+        return getCheckpointedValue(n, ok, customCheckpoints[row], customTerms, row, k_value);
+    }
 
-    if(!ok)
+    if(n-nMin >= customTerms.getSize(row))
+        ok = saveCustomSeqValues(n, row);
+
+    if(!ok || n-nMin >= customTerms.getSize(row))
         return nan("");
 
-    return seqValues[drawsNum][n-nMin];
+    return customTerms.at(row, n-nMin);
+}
+
+int SeqCalculator::getCustomRow(double k_value)
+{
+    int row = customKs.indexOf(k_value);
+
+    if(row != -1)
+        return row;
+
+    if(customKs.size() < SEQ_CUSTOM_ROWS_NUM)
+    {
+        customKs << k_value;
+        customTerms.setRowsNum(customKs.size());
+        customCheckpoints << SeqCheckpoints();
+
+        return customKs.size() - 1;
+    }
+
+    row = 0;
+
+    for(int i = 1 ; i < customKs.size() ; i++)
+        if(customTerms.getLastUse(i) < customTerms.getLastUse(row))
+            row = i;
+
+    customKs[row] = k_value;
+    customTerms.clearRow(row);
+    customCheckpoints[row] = SeqCheckpoints();
+
+    return row;
 }
 
-bool SeqCalculator::saveCustomSeqValues(double nMax)
+bool SeqCalculator::saveCustomSeqValues(double nMax, int row)
 {
     if(blockCalculatingFromTree)
         return false;
@@ -225,32 +299,35 @@ bool SeqCalculator::saveCustomSeqValues(double nMax)
 
     double result;
     bool ok = true;
-    kPos = drawsNum;
-    k = custom_k;
+    kPos = row;
+    k = customKs[row];
+    currentTerms = &customTerms;
+    customTerms.setBusy(true);
 
-    if(seqValues[kPos].size() == 0)
+    if(customTerms.getSize(row) == 0)
     {
-        for(int i = 0; i < firstValsTrees.size(); i++)
+        for(int i = 0; i < firstValsTrees.size() && ok; i++)
         {
             result = calculateFromTree(firstValsTrees[i],i, ok);
 
-            if(!ok)
-                return false;
-
-            seqValues[kPos] << result;
+            if(ok)
+                customTerms.append(row, result);
         }
     }
 
-    for(int n = seqValues[kPos].size() + nMin; n <= nMax + nMin; n++)
+    for(int n = customTerms.getSize(row) + nMin; n <= nMax + nMin && ok; n++)
     {
         result = calculateFromTree(seqTree, n, ok);
 
-        if(!ok)
-            return false;
-
-        seqValues[kPos] << result;
+        if(ok)
+            customTerms.append(row, result);
     }
 
+    customTerms.setBusy(false);
+
+    if(!ok)
+        return false;
+
     blockCalculatingFromTree = false;
 
     return true;
@@ -258,36 +335,448 @@ bool SeqCalculator::saveCustomSeqValues(double nMax)
 
 double SeqCalculator::getSeqValue(double n, bool &ok, int index_k)
 {   
-    if(n < nMin || seqValues[0].size() > MAX_SAVED_SEQ_VALS)
+    if(n < nMin || n-nMin > MAX_FAST_FORWARDED_SEQ_VALS || index_k < 0 || index_k >= drawsNum)
         return nan("");
 
-    if(n-nMin >= seqValues[0].size())
+    if(n-nMin > MAX_SAVED_SEQ_VALS)
+    {
+        while(checkpoints.size() <= index_k)
+            checkpoints << SeqCheckpoints();
+
+        return getCheckpointedValue(n, ok, checkpoints[index_k], terms, index_k, kRange.start + index_k * kRange.step);
+    }
+
+    if(n-nMin >= terms.getSize(index_k))
     {
-        ok = isValid = saveSeqValues(n);
+        ok = isValid = saveSeqValues(n, index_k);
         blockCalculatingFromTree = false;
     }
 
+    if(!ok || n-nMin >= terms.getSize(index_k))
+        return nan("");
+
+    return terms.at(index_k, n-nMin);
+}
+
+bool SeqCalculator::getSeqExtrema(double nFrom, double nTo, int index_k, double &min, double &max)
+{
+    // the terms are computed and stored up to nTo, then read from the per block summaries of the store
+
+    if(nFrom < nMin || nTo < nFrom || nTo-nMin > MAX_SAVED_SEQ_VALS || index_k < 0 || index_k >= drawsNum)
+        return false;
+
+    bool ok = true;
+    getSeqValue(nTo, ok, index_k);
+
+    if(!ok || nTo-nMin >= terms.getSize(index_k))
+        return false;
+
+    return terms.getExtrema(index_k, nFrom-nMin, nTo-nMin, min, max);
+}
+
+int SeqCalculator::getRecurrenceDepth()
+{
+    // far terms are computed again from checkpoints holding the terms preceding them, as many as
+    // the first values: the expression can only ask for terms within that distance
+
+    if(recurrenceDepth == -2)
+    {
+        recurrenceDepth = firstValsTrees.size();
+
+        if(seqTree == nullptr || recurrenceDepth == 0 || recurrenceDepth > SEQ_CHECKPOINT_INTERVAL ||
+                !isLocalRecurrence(seqTree, recurrenceDepth))
+            recurrenceDepth = -1;
+    }
+
+    return recurrenceDepth;
+}
+
+bool SeqCalculator::isLocalRecurrence(FastTree *tree, int depth)
+{
+    if(tree == nullptr)
+        return true;
+
+    if(tree->type == seqNum + SEQUENCES_START + 1)
+    {
+        int distance;
+        return getSelfCallDistance(tree, distance) && 1 <= distance && distance <= depth;
+    }
+
+    return isLocalRecurrence(tree->left, depth) && isLocalRecurrence(tree->right, depth);
+}
+
+static QVector<double> multiplyMatrices(const QVector<double> &a, const QVector<double> &b, int size)
+{
+    QVector<double> result(size * size, 0);
+
+    for(int i = 0 ; i < size ; i++)
+        for(int l = 0 ; l < size ; l++)
+        {
+            double coef = a[i * size + l];
+
+            if(coef != 0)
+                for(int j = 0 ; j < size ; j++)
+                    result[i * size + j] += coef * b[l * size + j];
+        }
+
+    return result;
+}
+
+bool SeqCalculator::isConstantTree(FastTree *tree)
+{
+    if(tree == nullptr || tree->type == NUMBER || tree->type == PAR_K)
+        return true;
+
+    bool knownType = tree->type == PLUS || tree->type == MINUS || tree->type == MULTIPLY || tree->type == DIVIDE ||
+            tree->type == POW || (REF_FUNC_START < tree->type && tree->type < REF_FUNC_END) ||
+            (FUNC_START < tree->type && tree->type < FUNC_END) || (DERIV_START < tree->type && tree->type < DERIV_END);
+
+    return knownType && isConstantTree(tree->left) && isConstantTree(tree->right);
+}
+
+bool SeqCalculator::getLinearForm(FastTree *tree, QVector<double> &form, int depth)
+{
+    // form: the coefficients of the terms 1 to depth positions before, then the constant term
+
+    form.fill(0, depth + 1);
+
+    if(isConstantTree(tree))
+    {
+        bool ok = true;
+        form[depth] = calculateFromTree(tree, 0, ok);
+
+        return ok && std::isfinite(form[depth]);
+    }
+
+    int distance;
+
+    if(tree->type == seqNum + SEQUENCES_START + 1)
+    {
+        if(!getSelfCallDistance(tree, distance) || distance < 1 || distance > depth)
+            return false;
+
+        form[distance - 1] = 1;
+        return true;
+    }
+
+    QVector<double> left, right;
+
+    if(tree->type != PLUS && tree->type != MINUS && tree->type != MULTIPLY && tree->type != DIVIDE)
+        return false;
+
+    if(!getLinearForm(tree->left, left, depth) || !getLinearForm(tree->right, right, depth))
+        return false;
+
+    bool leftConstant = true, rightConstant = true;
+
+    for(int i = 0 ; i < depth ; i++)
+    {
+        leftConstant = leftConstant && left[i] == 0;
+        rightConstant = rightConstant && right[i] == 0;
+    }
+
+    if(tree->type == PLUS || tree->type == MINUS)
+    {
+        double sign = tree->type == PLUS ? 1 : -1;
+
+        for(int i = 0 ; i <= depth ; i++)
+            form[i] = left[i] + sign * right[i];
+    }
+    else if(tree->type == MULTIPLY && rightConstant)
+    {
+        for(int i = 0 ; i <= depth ; i++)
+            form[i] = left[i] * right[depth];
+    }
+    else if(tree->type == MULTIPLY && leftConstant)
+    {
+        for(int i = 0 ; i <= depth ; i++)
+            form[i] = right[i] * left[depth];
+    }
+    else if(tree->type == DIVIDE && rightConstant && right[depth] != 0)
+    {
+        for(int i = 0 ; i <= depth ; i++)
+            form[i] = left[i] / right[depth];
+    }
+    else return false;
+
+    return true;
+}
+
+bool SeqCalculator::getLinearValue(qint64 pos, SeqCheckpoints &cp, SeqTermStore &store, int row, double kValue, double &result)
+{
+    // a recurrence t(p) = a1 t(p-1) + ... + ad t(p-d) + b moves the state [t(p-1) ... t(p-d) 1] forward through
+    // its companion matrix M. The last state reached is kept: close terms are a few steps away from it,
+    // far ones are reached by raising M to a power by squaring
+
+    int depth = getRecurrenceDepth();
+
+    if(depth < 0 || store.getSize(row) < depth || pos < depth)
+        return false;
+
+    if(cp.linear == -1)
+    {
+        // may be reached from within a running computation, whose k must be left as it is
+
+        double savedK = k;
+        k = kValue;
+        cp.linear = getLinearForm(seqTree, cp.linearForm, depth) ? 1 : 0;
+        k = savedK;
+    }
+
+    if(cp.linear == 0)
+        return false;
+
+    int size = depth + 1;
+
+    if(cp.linearMatrix.isEmpty())
+    {
+        cp.linearMatrix.fill(0, size * size);
+
+        for(int j = 0 ; j < size ; j++)
+            cp.linearMatrix[j] = cp.linearForm[j];
+        for(int i = 1 ; i < depth ; i++)
+            cp.linearMatrix[i * size + i - 1] = 1;
+        cp.linearMatrix[depth * size + depth] = 1;
+    }
+
+    if(cp.statePos < 0 || pos < cp.statePos - depth)
+    {
+        // the first values make the state at position depth
+
+        cp.linearState.fill(1, size);
+        for(int j = 0 ; j < depth ; j++)
+            cp.linearState[j] = store.at(row, depth - 1 - j);
+
+        cp.statePos = depth;
+    }
+
+    if(pos >= cp.statePos)
+    {
+        quint64 steps = pos + 1 - cp.statePos;
+
+        if(steps <= SEQ_LINEAR_STEPS)
+        {
+            for(quint64 step = 0 ; step < steps ; step++)
+            {
+                double next = cp.linearForm[depth];
+
+                for(int j = 0 ; j < depth ; j++)
+                    next += cp.linearForm[j] * cp.linearState[j];
+
+                for(int j = depth - 1 ; j > 0 ; j--)
+                    cp.linearState[j] = cp.linearState[j - 1];
+
+                cp.linearState[0] = next;
+            }
+        }
+        else
+        {
+            QVector<double> matrix = cp.linearMatrix, power(size * size, 0), state(size, 0);
+
+            for(int i = 0 ; i < size ; i++)
+                power[i * size + i] = 1;
+
+            for(quint64 exponent = steps ; exponent > 0 ; exponent >>= 1)
+            {
+                if(exponent & 1)
+                    power = multiplyMatrices(power, matrix, size);
+
+                if(exponent > 1)
+                    matrix = multiplyMatrices(matrix, matrix, size);
+            }
+
+            for(int i = 0 ; i < size ; i++)
+                for(int j = 0 ; j < size ; j++)
+                    state[i] += power[i * size + j] * cp.linearState[j];
+
+            cp.linearState = state;
+        }
+
+        cp.statePos = pos + 1;
+    }
+
+    result = cp.linearState[cp.statePos - 1 - pos];
+
+    return true;
+}
+
+bool SeqCalculator::getSelfCallDistance(FastTree *tree, int &distance)
+{
+    // the term computed at position p is u(p - nMin), asking u(n - c) reads position p - nMin - c
+
+    FastTree *arg = tree->right;
+    double c;
+
+    if(arg->type == MINUS && arg->left->type == VAR_N && arg->right->type == NUMBER)
+        c = *arg->right->value;
+    else if(arg->type == PLUS && arg->left->type == VAR_N && arg->right->type == NUMBER)
+        c = - *arg->right->value;
+    else return false;
+
+    if(c != floor(c))
+        return false;
+
+    distance = c + nMin;
+
+    return true;
+}
+
+double SeqCalculator::getCheckpointedValue(double n, bool &ok, SeqCheckpoints &cp, SeqTermStore &store, int row, double kValue)
+{
+    qint64 pos = n - nMin;
+    int depth = getRecurrenceDepth();
+    double result;
+
+    if(getLinearValue(pos, cp, store, row, kValue, result))
+        return result;
+
+    if(pos > MAX_CHECKPOINTED_SEQ_VALS)
+        return nan("");
+
+    if(pos >= cp.windowStart && pos - cp.windowStart < cp.window.size())
+        return cp.window[pos - cp.windowStart];
+
+    if(depth < 0 || store.getSize(row) < depth || blockCalculatingFromTree || checkpointsScheduled)
+    {
+        ok = false;
+        return nan("");
+    }
+
+    QVector<double> buffer;
+    int windowIndex = pos / SEQ_CHECKPOINT_INTERVAL;
+
+    // checkpoint j holds the terms preceding position j * SEQ_CHECKPOINT_INTERVAL, the first values stand for checkpoint 0.
+    // The checkpoints within the stored terms are read from them, the next ones are computed
+    // SEQ_CHECKPOINTS_PER_CALL at a time: until they all are, the term isn't ready
+
+    while(cp.states.size() / depth < windowIndex && (cp.states.size() / depth + 1) * SEQ_CHECKPOINT_INTERVAL <= store.getSize(row))
+    {
+        int end = (cp.states.size() / depth + 1) * SEQ_CHECKPOINT_INTERVAL;
+
+        for(int i = end - depth ; i < end ; i++)
+            cp.states << store.at(row, i);
+    }
+
+    blockCalculatingFromTree = true;
+    k = kValue;
+
+    for(int built = 0 ; ok && cp.states.size() / depth < windowIndex ; built++)
+    {
+        int j = cp.states.size() / depth;
+
+        if(built == SEQ_CHECKPOINTS_PER_CALL)
+        {
+            blockCalculatingFromTree = false;
+            checkpointsScheduled = true;
+            QTimer::singleShot(0, this, SLOT(resumeCheckpoints()));
+
+            ok = false;
+            return nan("");
+        }
+
+        if(j == 0)
+        {
+            buffer.clear();
+            for(int i = 0 ; i < depth ; i++)
+                buffer << store.at(row, i);
+
+            ok = extendWindow(buffer, 0, SEQ_CHECKPOINT_INTERVAL);
+        }
+        else
+        {
+            buffer = cp.states.mid((j - 1) * depth, depth);
+            ok = extendWindow(buffer, j * SEQ_CHECKPOINT_INTERVAL - depth, (j + 1) * SEQ_CHECKPOINT_INTERVAL);
+        }
+
+        if(ok)
+            cp.states << buffer.mid(buffer.size() - depth);
+    }
+
+    if(ok)
+    {
+        if(windowIndex == 0)
+        {
+            buffer.clear();
+            for(int i = 0 ; i < depth ; i++)
+                buffer << store.at(row, i);
+
+            ok = extendWindow(buffer, 0, SEQ_CHECKPOINT_INTERVAL);
+            cp.windowStart = 0;
+            cp.window = buffer;
+        }
+        else
+        {
+            buffer = cp.states.mid((windowIndex - 1) * depth, depth);
+            ok = extendWindow(buffer, windowIndex * SEQ_CHECKPOINT_INTERVAL - depth, (windowIndex + 1) * SEQ_CHECKPOINT_INTERVAL);
+            cp.windowStart = windowIndex * SEQ_CHECKPOINT_INTERVAL;
+            cp.window = buffer.mid(depth);
+        }
+    }
+
+    blockCalculatingFromTree = false;
+
     if(!ok)
+    {
+        cp.window.clear();
         return nan("");
+    }
+
+    return cp.window[pos - cp.windowStart];
+}
+
+void SeqCalculator::resumeCheckpoints()
+{
+    checkpointsScheduled = false;
+    revision++;
 
-    if(0 <= index_k && index_k < drawsNum)
+    emit checkpointsExtended();
+}
+
+bool SeqCalculator::extendWindow(QVector<double> &buffer, int bufferStart, int end)
+{
+    // the expression reads its own terms from the buffer, which holds the positions from bufferStart
+
+    bool ok = true;
+    currentWindow = &buffer;
+    currentWindowStart = bufferStart;
+
+    buffer.reserve(end - bufferStart);
+
+    for(int pos = bufferStart + buffer.size() ; pos < end && ok ; pos++)
+        buffer << calculateFromTree(seqTree, pos - nMin, ok);
+
+    currentWindow = nullptr;
+
+    return ok;
+}
+
+double SeqCalculator::readWindowTerm(double n, bool &ok)
+{
+    double pos = n - currentWindowStart;
+
+    if(ceil(pos) != pos || pos < 0 || pos >= currentWindow->size())
     {
-        double res = seqValues[index_k][n-nMin];
-        return res;
+        errorMessageLabel->setText(tr("Invalid recursion."));
+        ok = false;
+
+        return nan("");
     }
-    else return nan("");
+
+    return currentWindow->at(pos);
 }
 
 void SeqCalculator::updateSeqValuesSize()
 {
-    int size = trunc((kRange.end - kRange.start)/kRange.step) + 2;
+    int size = trunc((kRange.end - kRange.start)/kRange.step) + 1;
 
-    for(int i = seqValues.size() ; i < size ; i++)
-        seqValues << QList<double>();
+    if(terms.getRowsNum() < size)
+        terms.setRowsNum(size);
 }
 
-bool SeqCalculator::saveSeqValues(double nMax)
+bool SeqCalculator::saveSeqValues(double nMax, int row)
 {
+    // only the asked row gets computed, the others may have been evicted
+
     if(blockCalculatingFromTree)
     {
         errorMessageLabel->setText(tr("Invalid crossed recursion between this sequence and the other(s) it calls in its expression."));
@@ -303,31 +792,29 @@ bool SeqCalculator::saveSeqValues(double nMax)
 
     double result;
 
-    k = kRange.start;
+    kPos = row;
+    k = kRange.start + row * kRange.step;
+    currentTerms = &terms;
+    terms.setBusy(true);
 
-    for(kPos = 0; kPos < drawsNum; kPos++)
+    for(int n = terms.getSize(row) - nMin; n <= nMax && ok ; n++)
     {
-        for(int n = seqValues[kPos].size() - nMin; n <= nMax ; n++)
-        {
-            result = calculateFromTree(seqTree, n, ok);
-
-            if(!ok)
-                return false;
-
-            seqValues[kPos] << result;
-        }
+        result = calculateFromTree(seqTree, n, ok);
 
-        k += kRange.step;
+        if(ok)
+            terms.append(row, result);
     }
 
-    return true;
+    terms.setBusy(false);
+
+    return ok;
 }
 
 bool SeqCalculator::calculateAndSaveFirstValuesTrees()
 {
     updateSeqValuesSize();
 
-    if(seqValues[0].size() >= firstValsTrees.size())
+    if(terms.getSize(0) >= firstValsTrees.size())
         return true;
 
     bool ok = true;
@@ -335,25 +822,26 @@ bool SeqCalculator::calculateAndSaveFirstValuesTrees()
     k = kRange.start;
 
     int savedKpos = kPos;
+    currentTerms = &terms;
+    terms.setBusy(true);
 
-    for(kPos = 0; kPos < drawsNum; kPos++)
+    for(kPos = 0; kPos < drawsNum && ok; kPos++)
     {
-        for(int i = 0; i < firstValsTrees.size(); i++)
+        for(int i = 0; i < firstValsTrees.size() && ok; i++)
         {
             result = calculateFromTree(firstValsTrees[i], 0, ok);
 
-            if(!ok)
-                return false;
-
-            seqValues[kPos] << result;
+            if(ok)
+                terms.append(kPos, result);
         }
 
         k += kRange.step;
     }
 
+    terms.setBusy(false);
     kPos = savedKpos;
 
-    return true;
+    return ok;
 }
 
 double SeqCalculator::calculateFromTree(FastTree *tree, double x, bool &ok)
@@ -409,9 +897,13 @@ double SeqCalculator::calculateFromTree(FastTree *tree, double x, bool &ok)
     else if(tree->type == seqNum + SEQUENCES_START + 1)
     {
         double asked_n = calculateFromTree(tree->right, x, ok);
+
+        if(currentWindow != nullptr)
+            return readWindowTerm(asked_n, ok);
+
         ok = verifyAskedTerm(asked_n);
         if(ok)
-            return seqValues[kPos][asked_n];
+            return currentTerms->at(kPos, asked_n);
         else return nan("");
     }
     else if(SEQUENCES_START < tree->type && tree->type < SEQUENCES_END)
@@ -429,7 +921,7 @@ double SeqCalculator::calculateFromTree(FastTree *tree, double x, bool &ok)
 
 bool SeqCalculator::verifyAskedTerm(double n)
 {
-    if(ceil(n) != n || n-nMin >= seqValues[kPos].size())
+    if(ceil(n) != n || n-nMin >= currentTerms->getSize(kPos))
     {
         errorMessageLabel->setText(tr("Invalid recursion."));
 
@@ -30,6 +30,25 @@
 #include "treecreator.h"
 #include "funccalculator.h"
 #include "colorsaver.h"
+#include "seqtermstore.h"
+
+#define SEQ_CUSTOM_ROWS_NUM 8 // k values out of the k range whose terms are kept
+#define SEQ_CHECKPOINT_INTERVAL 4096 // past MAX_SAVED_SEQ_VALS, the recurrence's state is kept every this many terms
+#define MAX_CHECKPOINTED_SEQ_VALS 1000000000
+#define SEQ_CHECKPOINTS_PER_CALL 32 // checkpoints built per asked term, the next ones once the event loop ran
+#define MAX_FAST_FORWARDED_SEQ_VALS 1E15 // farthest term of a linear recurrence
+#define SEQ_LINEAR_STEPS 64 // terms closer than this to the last reached state are stepped to, not exponentiated
+
+struct SeqCheckpoints
+{
+    QVector<double> states; // per checkpoint, the terms that precede it
+    QVector<double> window; // terms computed again from a checkpoint, from windowStart
+    int windowStart = 0;
+    int linear = -1; // 1 when the terms follow linearForm, 0 when they don't, -1 until known
+    QVector<double> linearForm, linearMatrix;
+    QVector<double> linearState; // [t(statePos-1) ... t(statePos-depth) 1]
+    qint64 statePos = -1;
+};
 
 class SeqCalculator : public QObject
 {
@@ -58,9 +77,12 @@ public:
 
     int getDrawsNum();
     int get_nMin();    
+    int getRevision();
+    qint64 getMemoryUsage();
 
     Range getKRange();
     double getSeqValue(double n, bool &ok, int index_k = 0);
+    bool getSeqExtrema(double nFrom, double nTo, int index_k, double &min, double &max); // only up to the stored terms
     double getCustomSeqValue(double n, bool &ok, double k_value);
 
 public slots:
@@ -69,6 +91,10 @@ public slots:
 
 signals:
     void colorChanged(int id);
+    void checkpointsExtended(); // terms that weren't ready may be asked again
+
+protected slots:
+    void resumeCheckpoints();
 
 protected:
 
@@ -78,20 +104,31 @@ protected:
     bool checkCalledSeqsValidity(QString str);
     bool calculateAndSaveFirstValuesTrees();
     void updateSeqValuesSize();
+    void clearTerms();
+    int getCustomRow(double k_value);
+    int getRecurrenceDepth();
+    bool isLocalRecurrence(FastTree *tree, int depth);
+    bool getSelfCallDistance(FastTree *tree, int &distance);
+    bool isConstantTree(FastTree *tree);
+    bool getLinearForm(FastTree *tree, QVector<double> &form, int depth);
+    bool getLinearValue(qint64 pos, SeqCheckpoints &cp, SeqTermStore &store, int row, double kValue, double &result);
+    double getCheckpointedValue(double n, bool &ok, SeqCheckpoints &cp, SeqTermStore &store, int row, double kValue);
+    bool extendWindow(QVector<double> &buffer, int bufferStart, int end);
+    double readWindowTerm(double n, bool &ok);
 
     double calculateFromTree(FastTree *tree, double n, bool &ok);
 
     bool validateSeqFirstValsTrees();
-    bool saveSeqValues(double nMax);
-    bool saveCustomSeqValues(double nMax);
+    bool saveSeqValues(double nMax, int row);
+    bool saveCustomSeqValues(double nMax, int row);
     bool verifyAskedTerm(double n);
     bool verifyOtherSeqAskedTerm(double n, int id);
 
     QLabel *errorMessageLabel;
 
-    int seqNum, kPos, nMin, drawsNum;
-    bool isExprValidated, areFirstValsValidated, isParametric, isValid, blockCalculatingFromTree, drawState, isKRangeValid;
-    double custom_k, k;
+    int seqNum, kPos, nMin, drawsNum, revision;
+    bool isExprValidated, areFirstValsValidated, isParametric, isValid, blockCalculatingFromTree, drawState, isKRangeValid, checkpointsScheduled;
+    double k;
     ColorSaver *colorSaver;
     Range kRange;
     TreeCreator treeCreator, firstValsTreeCreator;
@@ -103,7 +140,13 @@ protected:
     QList<double (*)(double)> refFuncs;
 
     QList<FastTree*> firstValsTrees;
-    QList< QList<double> > seqValues;    
+    SeqTermStore terms; // a row per k value of the k range
+    SeqTermStore customTerms; // a row per k value of customKs
+    SeqTermStore *currentTerms; // the one being filled, read by the sequence's expression
+    QList<double> customKs;
+    QList<SeqCheckpoints> checkpoints, customCheckpoints; // a row each, for the terms past MAX_SAVED_SEQ_VALS
+    QVector<double> *currentWindow; // when not null, the terms being computed again from a checkpoint
+    int currentWindowStart, recurrenceDepth; // recurrenceDepth: -1 if far terms can't be reached, -2 until known
 };
 
 #endif // SEQCALCULATOR_H
@@ -0,0 +1,273 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#include "Calculus/seqtermstore.h"
+
+QList<SeqTermStore*> SeqTermStore::stores;
+qint64 SeqTermStore::totalMemoryUsage = 0;
+qint64 SeqTermStore::memoryBudget = -1;
+quint64 SeqTermStore::useCounter = 0;
+int SeqTermStore::evictedRowsNum = 0;
+
+SeqTermStore::SeqTermStore()
+{
+    pinnedTerms = 0;
+    busy = false;
+    memoryUsage = 0;
+
+    if(memoryBudget < 0)
+    {
+        QSettings settings;
+        memoryBudget = settings.value("graph/sequences/memory_budget_mb", SEQ_MEMORY_BUDGET_MB).toLongLong() * 1024 * 1024;
+    }
+
+    stores << this;
+}
+
+void SeqTermStore::setRowsNum(int num)
+{
+    while(rows.size() > num)
+    {
+        truncate(rows.last(), 0);
+        rows.removeLast();
+    }
+
+    while(rows.size() < num)
+        rows << Row{QVector<double*>(), QVector<double>(), QVector<double>(), 0, 0};
+}
+
+int SeqTermStore::getRowsNum() const
+{
+    return rows.size();
+}
+
+void SeqTermStore::setPinnedTerms(int num)
+{
+    pinnedTerms = num;
+}
+
+void SeqTermStore::setBusy(bool isBusy)
+{
+    busy = isBusy;
+}
+
+void SeqTermStore::clear()
+{
+    setRowsNum(0);
+}
+
+void SeqTermStore::clearRow(int row)
+{
+    truncate(rows[row], 0);
+}
+
+int SeqTermStore::getSize(int row) const
+{
+    return rows[row].size;
+}
+
+quint64 SeqTermStore::getLastUse(int row) const
+{
+    return rows[row].lastUse;
+}
+
+double SeqTermStore::at(int row, int pos)
+{
+    Row &r = rows[row];
+    r.lastUse = ++useCounter;
+
+    return r.blocks[pos / SEQ_BLOCK_TERMS][pos % SEQ_BLOCK_TERMS];
+}
+
+void SeqTermStore::append(int row, double value)
+{
+    // stores get filled while busy, so that the row being appended to can't be truncated here
+
+    if(rows[row].size == rows[row].blocks.size() * SEQ_BLOCK_TERMS)
+        enforceBudget(SEQ_BLOCK_TERMS * sizeof(double));
+
+    Row &r = rows[row];
+
+    if(r.size == r.blocks.size() * SEQ_BLOCK_TERMS)
+    {
+        r.blocks << new double[SEQ_BLOCK_TERMS];
+        r.blockMin << qInf();
+        r.blockMax << -qInf();
+        memoryUsage += SEQ_BLOCK_TERMS * sizeof(double);
+        totalMemoryUsage += SEQ_BLOCK_TERMS * sizeof(double);
+    }
+
+    r.blocks.last()[r.size % SEQ_BLOCK_TERMS] = value;
+    r.size++;
+
+    double &blockMin = r.blockMin.last(), &blockMax = r.blockMax.last();
+
+    if(!qIsFinite(value))
+        blockMin = blockMax = nan("");
+    else if(!std::isnan(blockMin))
+    {
+        blockMin = qMin(blockMin, value);
+        blockMax = qMax(blockMax, value);
+    }
+    r.lastUse = ++useCounter;
+}
+
+bool SeqTermStore::getExtrema(int row, int from, int to, double &min, double &max)
+{
+    // whole blocks are read from their summary, only the partial blocks at both ends are scanned
+
+    Row &r = rows[row];
+    r.lastUse = ++useCounter;
+
+    min = qInf();
+    max = -qInf();
+
+    for(int pos = from ; pos <= to ; )
+    {
+        int block = pos / SEQ_BLOCK_TERMS;
+        int last = qMin(to, (block + 1) * SEQ_BLOCK_TERMS - 1);
+
+        if(pos % SEQ_BLOCK_TERMS == 0 && last == (block + 1) * SEQ_BLOCK_TERMS - 1)
+        {
+            if(std::isnan(r.blockMin[block]))
+                return false;
+
+            min = qMin(min, r.blockMin[block]);
+            max = qMax(max, r.blockMax[block]);
+        }
+        else for(int i = pos % SEQ_BLOCK_TERMS ; i <= last % SEQ_BLOCK_TERMS ; i++)
+        {
+            double value = r.blocks[block][i];
+
+            if(!qIsFinite(value))
+                return false;
+
+            min = qMin(min, value);
+            max = qMax(max, value);
+        }
+
+        pos = last + 1;
+    }
+
+    return from <= to;
+}
+
+void SeqTermStore::summarizeBlock(Row &row, int block, int size)
+{
+    row.blockMin[block] = qInf();
+    row.blockMax[block] = -qInf();
+
+    for(int i = 0 ; i < size ; i++)
+    {
+        double value = row.blocks[block][i];
+
+        if(!qIsFinite(value))
+        {
+            row.blockMin[block] = row.blockMax[block] = nan("");
+            return;
+        }
+
+        row.blockMin[block] = qMin(row.blockMin[block], value);
+        row.blockMax[block] = qMax(row.blockMax[block], value);
+    }
+}
+
+void SeqTermStore::truncate(Row &row, int size)
+{
+    if(size >= row.size)
+        return;
+
+    int blocksNum = (size + SEQ_BLOCK_TERMS - 1) / SEQ_BLOCK_TERMS;
+
+    while(row.blocks.size() > blocksNum)
+    {
+        delete[] row.blocks.last();
+        row.blocks.removeLast();
+        row.blockMin.removeLast();
+        row.blockMax.removeLast();
+
+        memoryUsage -= SEQ_BLOCK_TERMS * sizeof(double);
+        totalMemoryUsage -= SEQ_BLOCK_TERMS * sizeof(double);
+    }
+
+    row.size = size;
+
+    if(size % SEQ_BLOCK_TERMS != 0) // the last block keeps fewer terms than it summarized
+        summarizeBlock(row, blocksNum - 1, size % SEQ_BLOCK_TERMS);
+}
+
+void SeqTermStore::enforceBudget(qint64 neededBytes)
+{
+    while(totalMemoryUsage + neededBytes > memoryBudget)
+    {
+        SeqTermStore *oldestStore = nullptr;
+        int oldestRow = -1;
+
+        for(SeqTermStore *store : stores)
+        {
+            if(store->busy)
+                continue;
+
+            int keptBlocks = (store->pinnedTerms + SEQ_BLOCK_TERMS - 1) / SEQ_BLOCK_TERMS;
+
+            for(int i = 0 ; i < store->rows.size() ; i++)
+                if(store->rows[i].blocks.size() > keptBlocks &&
+                        (oldestStore == nullptr || store->rows[i].lastUse < oldestStore->rows[oldestRow].lastUse))
+                {
+                    oldestStore = store;
+                    oldestRow = i;
+                }
+        }
+
+        if(oldestStore == nullptr) // everything left is in use, the budget gets exceeded
+            return;
+
+        oldestStore->truncate(oldestStore->rows[oldestRow], oldestStore->pinnedTerms);
+        evictedRowsNum++;
+    }
+}
+
+qint64 SeqTermStore::getMemoryUsage() const
+{
+    return memoryUsage;
+}
+
+qint64 SeqTermStore::getTotalMemoryUsage()
+{
+    return totalMemoryUsage;
+}
+
+qint64 SeqTermStore::getMemoryBudget()
+{
+    return memoryBudget;
+}
+
+int SeqTermStore::getEvictedRowsNum()
+{
+    return evictedRowsNum;
+}
+
+SeqTermStore::~SeqTermStore()
+{
+    clear();
+    stores.removeOne(this);
+}
@@ -0,0 +1,87 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#ifndef SEQTERMSTORE_H
+#define SEQTERMSTORE_H
+
+#include <QtWidgets>
+
+#define SEQ_BLOCK_TERMS 4096 // terms per storage block, 32 KiB
+#define SEQ_MEMORY_BUDGET_MB 256 // default budget of the terms of all the sequences, overridden by the "graph/sequences/memory_budget_mb" setting
+
+class SeqTermStore
+{
+    // Stores the terms of a sequence, one row per k value, in fixed size blocks of doubles.
+    // All the stores share a memory budget: past it, the least recently used rows of any store
+    // get truncated to their pinned first terms and are computed again when asked for.
+
+public:
+    SeqTermStore();
+    ~SeqTermStore();
+
+    void setRowsNum(int num);
+    int getRowsNum() const;
+    void setPinnedTerms(int num);
+    void setBusy(bool busy); // a busy store, being filled, doesn't get evicted
+    void clear();
+    void clearRow(int row);
+
+    int getSize(int row) const;
+    quint64 getLastUse(int row) const;
+    double at(int row, int pos);
+    void append(int row, double value);
+    bool getExtrema(int row, int from, int to, double &min, double &max); // false if a term in [from, to] isn't finite
+
+    qint64 getMemoryUsage() const;
+
+    static qint64 getTotalMemoryUsage();
+    static qint64 getMemoryBudget();
+    static int getEvictedRowsNum();
+
+protected:
+    struct Row
+    {
+        QVector<double*> blocks;
+        QVector<double> blockMin, blockMax; // per block, NaN once the block holds a term that isn't finite
+        int size;
+        quint64 lastUse;
+    };
+
+    void truncate(Row &row, int size);
+    void summarizeBlock(Row &row, int block, int size);
+    static void enforceBudget(qint64 neededBytes);
+
+    QList<Row> rows;
+    int pinnedTerms;
+    bool busy;
+    qint64 memoryUsage;
+
+    static QList<SeqTermStore*> stores;
+    static qint64 totalMemoryUsage, memoryBudget;
+    static quint64 useCounter;
+    static int evictedRowsNum;
+
+private:
+    Q_DISABLE_COPY(SeqTermStore) // owns its blocks and is registered in stores
+};
+
+#endif // SEQTERMSTORE_H
@@ -0,0 +1,218 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#include "GraphDraw/datalinelod.h"
+
+DataLineLod::DataLineLod()
+{
+    lodRevision = -1;
+    sorted = false;
+}
+
+void DataLineLod::build(const QList<QPointF> &points)
+{
+    polygon = QPolygonF::fromList(points);
+    levels.clear();
+
+    sorted = true;
+    for(int i = 1 ; i < polygon.size() && sorted ; i++)
+        sorted = polygon[i-1].x() <= polygon[i].x();
+
+    if(!sorted)
+        return;
+
+    // each level merges the groups of the previous one two by two
+
+    int groups = polygon.size();
+
+    while(groups > LOD_MIN_GROUPS)
+    {
+        EnvelopeLevel level;
+        int previousGroups = groups;
+        groups = (groups + 1) / 2;
+
+        level.minPos.resize(groups);
+        level.maxPos.resize(groups);
+
+        for(int g = 0 ; g < groups ; g++)
+        {
+            int left = 2 * g, right = qMin(2 * g + 1, previousGroups - 1);
+            int minLeft, minRight, maxLeft, maxRight;
+
+            if(levels.isEmpty())
+            {
+                minLeft = maxLeft = left;
+                minRight = maxRight = right;
+            }
+            else
+            {
+                minLeft = levels.last().minPos[left];
+                maxLeft = levels.last().maxPos[left];
+                minRight = levels.last().minPos[right];
+                maxRight = levels.last().maxPos[right];
+            }
+
+            level.minPos[g] = polygon[minRight].y() < polygon[minLeft].y() ? minRight : minLeft;
+            level.maxPos[g] = polygon[maxRight].y() > polygon[maxLeft].y() ? maxRight : maxLeft;
+        }
+
+        levels << level;
+    }
+}
+
+QPolygonF DataLineLod::getPolyline(const QList<QPointF> &points, int revision, const QTransform &transform, const QRectF &area)
+{
+    // area is the painted part of the device, the returned polyline is in data coordinates
+
+    if(lodRevision != revision)
+    {
+        lodRevision = revision;
+        build(points);
+    }
+
+    if(!sorted || polygon.size() < 2)
+        return polygon;
+
+    QRectF view = transform.inverted().mapRect(area);
+
+    auto byAbscissa = [](const QPointF &pt, double x) { return pt.x() < x; };
+
+    // one point on each side of the view is kept so the line reaches the borders
+
+    int first = int(std::lower_bound(polygon.constBegin(), polygon.constEnd(), view.left(), byAbscissa) - polygon.constBegin());
+    int last = int(std::lower_bound(polygon.constBegin(), polygon.constEnd(), view.right(), byAbscissa) - polygon.constBegin());
+
+    first = qMax(0, first - 1);
+    last = qMin(polygon.size() - 1, last);
+
+    int visible = last - first + 1;
+    int columns = qMax(1, int(area.width()));
+
+    if(visible <= LOD_FULL_DETAIL_FACTOR * columns)
+        return polygon.mid(first, visible);
+
+    int levelIndex = qMin(levels.size() - 1, int(floor(log2(double(visible) / (2 * columns)))) - 1);
+
+    QPolygonF reduced;
+    reduced.reserve(4 * columns + 8);
+
+    int lastAdded = -1;
+
+    auto add = [&](int pos)
+    {
+        if(pos != lastAdded)
+        {
+            reduced << polygon[pos];
+            lastAdded = pos;
+        }
+    };
+
+    auto column = [&](int pos) { return floor(transform.m11() * polygon[pos].x() + transform.dx()); };
+
+    if(levelIndex < 0)
+    {
+        // plain M4 on the points themselves
+        int pos = first, minPos, maxPos, start;
+        double currentColumn;
+
+        while(pos <= last)
+        {
+            currentColumn = column(pos);
+            start = minPos = maxPos = pos;
+
+            for(pos++ ; pos <= last && column(pos) == currentColumn ; pos++)
+            {
+                if(polygon[pos].y() < polygon[minPos].y())
+                    minPos = pos;
+                else if(polygon[pos].y() > polygon[maxPos].y())
+                    maxPos = pos;
+            }
+
+            add(start);
+            add(qMin(minPos, maxPos));
+            add(qMax(minPos, maxPos));
+            add(pos - 1);
+        }
+
+        return reduced;
+    }
+
+    // the same reduction on the groups of the chosen level, a group belongs to the column of its first point
+
+    const EnvelopeLevel &level = levels[levelIndex];
+    int groupShift = levelIndex + 1;
+    int group = first >> groupShift, lastGroup = last >> groupShift;
+    int start, end, minPos, maxPos, groupMin, groupMax;
+    double currentColumn;
+
+    // the first and last groups may stick out of [first, last], their extrema are looked for in the part that doesn't
+
+    auto extrema = [&](int g, int &gMin, int &gMax)
+    {
+        int from = g << groupShift, to = ((g + 1) << groupShift) - 1;
+
+        if(from >= first && to <= last)
+        {
+            gMin = level.minPos[g];
+            gMax = level.maxPos[g];
+            return;
+        }
+
+        from = qMax(from, first);
+        to = qMin(to, last);
+        gMin = gMax = from;
+
+        for(int pos = from + 1 ; pos <= to ; pos++)
+        {
+            if(polygon[pos].y() < polygon[gMin].y())
+                gMin = pos;
+            if(polygon[pos].y() > polygon[gMax].y())
+                gMax = pos;
+        }
+    };
+
+    while(group <= lastGroup)
+    {
+        currentColumn = column(qMax(first, group << groupShift));
+        start = qMax(first, group << groupShift);
+        extrema(group, minPos, maxPos);
+
+        for(group++ ; group <= lastGroup && column(group << groupShift) == currentColumn ; group++)
+        {
+            extrema(group, groupMin, groupMax);
+
+            if(polygon[groupMin].y() < polygon[minPos].y())
+                minPos = groupMin;
+            if(polygon[groupMax].y() > polygon[maxPos].y())
+                maxPos = groupMax;
+        }
+
+        end = qMin(last, (group << groupShift) - 1);
+
+        add(start);
+        add(qMin(minPos, maxPos));
+        add(qMax(minPos, maxPos));
+        add(end);
+    }
+
+    return reduced;
+}
@@ -0,0 +1,57 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#ifndef DATALINELOD_H
+#define DATALINELOD_H
+
+#include <QtWidgets>
+
+#define LOD_FULL_DETAIL_FACTOR 4 // the visible points are drawn as they are when there are less than this many per pixel column
+#define LOD_MIN_GROUPS 1024 // the envelope pyramid stops once a level has less groups than this
+
+struct EnvelopeLevel
+{
+    QVector<int> minPos, maxPos; // for each group of 2^level consecutive points, positions of its lowest and highest ones
+};
+
+class DataLineLod
+{
+    // Level of detail representation of a data set's line. The points are converted to a polygon once,
+    // and when their abscissas are sorted, a pyramid of min/max envelopes lets each frame draw
+    // the first, lowest, highest and last points of every pixel column from the level
+    // that has a couple of groups per column, instead of going through every point.
+
+public:
+    DataLineLod();
+
+    QPolygonF getPolyline(const QList<QPointF> &points, int revision, const QTransform &transform, const QRectF &area);
+
+protected:
+    void build(const QList<QPointF> &points);
+
+    int lodRevision;
+    bool sorted;
+    QPolygonF polygon;
+    QList<EnvelopeLevel> levels; // levels[i] groups 2^(i+1) points
+};
+
+#endif // DATALINELOD_H
@@ -0,0 +1,186 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#include "GraphDraw/densitymap.h"
+
+DensityMap::DensityMap()
+{
+    binsRevision = -1;
+    binWidth = binHeight = 0;
+    columns = rows = 0;
+}
+
+void DensityMap::bin(const QList<QPointF> &points, const QRectF &region)
+{
+    origin = QPointF(floor(region.left() / binWidth) * binWidth, floor(region.top() / binHeight) * binHeight);
+    columns = int(ceil((region.right() - origin.x()) / binWidth));
+    rows = int(ceil((region.bottom() - origin.y()) / binHeight));
+
+    counts.fill(0, columns * rows);
+
+    // each worker owns a band of rows of the bins and counts the points falling in it,
+    // the bands don't overlap so they are filled in place, without any copy to merge
+
+    int bands = qMax(1, qMin(rows, QThread::idealThreadCount()));
+    int bandRows = (rows + bands - 1) / bands;
+    quint32 *bins = counts.data();
+
+    QList< QFuture<void> > futures;
+
+    for(int band = 0 ; band < bands ; band++)
+    {
+        int firstRow = band * bandRows;
+        int lastRow = qMin(rows, firstRow + bandRows);
+
+        futures << QtConcurrent::run([this, &points, bins, firstRow, lastRow]()
+        {
+            double column, row;
+
+            for(int i = 0 ; i < points.size() ; i++)
+            {
+                row = floor((points[i].y() - origin.y()) / binHeight);
+
+                if(row < firstRow || row >= lastRow)
+                    continue;
+
+                column = floor((points[i].x() - origin.x()) / binWidth);
+
+                if(0 <= column && column < columns)
+                    bins[int(row) * columns + int(column)]++;
+            }
+        });
+    }
+
+    for(auto &future : futures)
+        future.waitForFinished();
+}
+
+QVector<QRgb> DensityMap::colorRamp(const QColor &color)
+{
+    QVector<QRgb> ramp(256);
+    QColor light = color.lighter(150), dark = color.darker(200);
+    double t;
+
+    for(int i = 0 ; i < 256 ; i++)
+    {
+        t = i / 255.0;
+
+        QColor shade = QColor::fromRgbF(light.redF() + t * (dark.redF() - light.redF()),
+                                        light.greenF() + t * (dark.greenF() - light.greenF()),
+                                        light.blueF() + t * (dark.blueF() - light.blueF()),
+                                        0.25 + 0.75 * t);
+
+        ramp[i] = qPremultiply(shade.rgba());
+    }
+
+    return ramp;
+}
+
+bool DensityMap::draw(QPainter &painter, const QList<QPointF> &points, int revision, const QColor &color)
+{
+    // returns false, without drawing anything, when the data set is not dense enough in the painted area
+
+    QTransform transform = painter.transform();
+
+    QRectF area(0, 0, painter.device()->width(), painter.device()->height());
+    if(painter.hasClipping())
+        area &= transform.mapRect(painter.clipBoundingRect());
+
+    if(area.isEmpty() || points.size() < area.width() * area.height() * DENSITY_POINTS_PER_PIXEL)
+        return false;
+
+    QRectF view = transform.inverted().mapRect(area);
+
+    double newBinWidth = DENSITY_BIN_PX / fabs(transform.m11());
+    double newBinHeight = DENSITY_BIN_PX / fabs(transform.m22());
+
+    bool sameScale = fabs(newBinWidth - binWidth) <= 1E-9 * newBinWidth && fabs(newBinHeight - binHeight) <= 1E-9 * newBinHeight;
+    QRectF binned(origin, QSizeF(columns * binWidth, rows * binHeight));
+
+    if(binsRevision != revision || !sameScale || !binned.contains(view))
+    {
+        binWidth = newBinWidth;
+        binHeight = newBinHeight;
+        binsRevision = revision;
+
+        QRectF region = view.adjusted(-DENSITY_CACHE_MARGIN * view.width(), -DENSITY_CACHE_MARGIN * view.height(),
+                                      DENSITY_CACHE_MARGIN * view.width(), DENSITY_CACHE_MARGIN * view.height());
+
+        if((region.width() / binWidth) * (region.height() / binHeight) > DENSITY_MAX_BINS)
+            region = view;
+
+        bin(points, region);
+    }
+
+    int firstColumn = qMax(0, int(floor((view.left() - origin.x()) / binWidth)));
+    int firstRow = qMax(0, int(floor((view.top() - origin.y()) / binHeight)));
+    int lastColumn = qMin(columns - 1, int(floor((view.right() - origin.x()) / binWidth)));
+    int lastRow = qMin(rows - 1, int(floor((view.bottom() - origin.y()) / binHeight)));
+
+    if(lastColumn < firstColumn || lastRow < firstRow)
+        return false;
+
+    quint64 visiblePoints = 0;
+    quint32 maxCount = 0;
+
+    for(int row = firstRow ; row <= lastRow ; row++)
+    {
+        for(int column = firstColumn ; column <= lastColumn ; column++)
+        {
+            visiblePoints += counts[row * columns + column];
+            maxCount = qMax(maxCount, counts[row * columns + column]);
+        }
+    }
+
+    if(visiblePoints < area.width() * area.height() * DENSITY_POINTS_PER_PIXEL)
+        return false;
+
+    // counts are shown on a log scale, the image rows and columns follow the device's orientation
+
+    QVector<QRgb> ramp = colorRamp(color);
+    double scale = 255 / log1p(double(maxCount));
+    bool flipX = transform.m11() < 0, flipY = transform.m22() < 0;
+
+    int imageWidth = lastColumn - firstColumn + 1, imageHeight = lastRow - firstRow + 1;
+    QImage image(imageWidth, imageHeight, QImage::Format_ARGB32_Premultiplied);
+
+    for(int row = firstRow ; row <= lastRow ; row++)
+    {
+        QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(flipY ? lastRow - row : row - firstRow));
+
+        for(int column = firstColumn ; column <= lastColumn ; column++)
+        {
+            quint32 count = counts[row * columns + column];
+            line[flipX ? lastColumn - column : column - firstColumn] = count == 0 ? 0 : ramp[qBound(0, int(log1p(double(count)) * scale), 255)];
+        }
+    }
+
+    QRectF binsRect(origin.x() + firstColumn * binWidth, origin.y() + firstRow * binHeight, imageWidth * binWidth, imageHeight * binHeight);
+
+    painter.save();
+    painter.resetTransform();
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+    painter.drawImage(transform.mapRect(binsRect), image);
+    painter.restore();
+
+    return true;
+}
@@ -0,0 +1,55 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#ifndef DENSITYMAP_H
+#define DENSITYMAP_H
+
+#include <QtWidgets>
+#include <QtConcurrent>
+
+#define DENSITY_POINTS_PER_PIXEL 0.5 // above this many visible points per pixel, a data set is drawn as a density map
+#define DENSITY_BIN_PX 2 // bin side, in pixels
+#define DENSITY_CACHE_MARGIN 1 // in view sizes: the bins cover this much around the view, so panning reuses them
+#define DENSITY_MAX_BINS (1 << 24)
+
+class DensityMap
+{
+    // 2D histogram of a data set on a lattice aligned in data coordinates, drawn with a color ramp
+    // from a transparent tint of the data set's color to a dark shade of it
+
+public:
+    DensityMap();
+
+    bool draw(QPainter &painter, const QList<QPointF> &points, int revision, const QColor &color);
+
+protected:
+    void bin(const QList<QPointF> &points, const QRectF &region);
+    QVector<QRgb> colorRamp(const QColor &color);
+
+    int binsRevision;
+    double binWidth, binHeight;
+    QPointF origin; // data coordinates of the corner of the first bin
+    int columns, rows;
+    QVector<quint32> counts;
+};
+
+#endif // DENSITYMAP_H
@@ -0,0 +1,104 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#include "GraphDraw/framescheduler.h"
+
+FrameScheduler::FrameScheduler(QWidget *paintedWidget)
+{
+    widget = paintedWidget;
+
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(deliverFrame()));
+
+    clock.start();
+    lastFrameStart = -1000;
+    painting = pending = false;
+    droppedFrames = 0;
+}
+
+double FrameScheduler::getFrameInterval()
+{
+    QWindow *window = widget->window()->windowHandle();
+    QScreen *screen = window != nullptr ? window->screen() : QGuiApplication::primaryScreen();
+
+    double refreshRate = screen != nullptr ? screen->refreshRate() : DEFAULT_REFRESH_RATE;
+
+    if(refreshRate < 1)
+        refreshRate = DEFAULT_REFRESH_RATE;
+
+    return 1000 / refreshRate;
+}
+
+void FrameScheduler::requestFrame()
+{
+    // requests made while painting are delivered in the next interval
+
+    if(painting)
+    {
+        pending = true;
+        return;
+    }
+
+    if(timer.isActive())
+        return;
+
+    qint64 wait = qint64(ceil(getFrameInterval())) - (clock.elapsed() - lastFrameStart);
+    timer.start(int(qMax(qint64(0), wait)));
+}
+
+void FrameScheduler::deliverFrame()
+{
+    widget->repaint();
+}
+
+void FrameScheduler::beginFrame()
+{
+    painting = true;
+    pending = false;
+    lastFrameStart = clock.elapsed();
+    frameClock.start();
+}
+
+void FrameScheduler::endFrame()
+{
+    painting = false;
+
+    double interval = getFrameInterval();
+    qint64 frameTime = frameClock.elapsed();
+
+    if(frameTime > interval)
+    {
+        droppedFrames += int(frameTime / interval);
+        emit framesDropped(droppedFrames);
+    }
+
+    if(pending)
+    {
+        pending = false;
+        requestFrame();
+    }
+}
+
+bool FrameScheduler::isOverBudget()
+{
+    return painting && frameClock.elapsed() > getFrameInterval() * FRAME_BUDGET_RATIO;
+}
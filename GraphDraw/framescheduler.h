@@ -0,0 +1,62 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QtWidgets>
+
+#define FRAME_BUDGET_RATIO 0.75 // part of the refresh interval a frame may spend before non urgent work is deferred
+#define DEFAULT_REFRESH_RATE 60
+
+class FrameScheduler : public QObject
+{
+    // Coalesces the frame requests of a widget to the display refresh rate, and paints it synchronously
+    // once per refresh interval. Frames longer than the interval are counted as dropped.
+
+    Q_OBJECT
+public:
+    explicit FrameScheduler(QWidget *paintedWidget);
+
+    void requestFrame();
+    void beginFrame();
+    void endFrame();
+    bool isOverBudget();
+
+signals:
+    void framesDropped(int total);
+
+protected slots:
+    void deliverFrame();
+
+protected:
+    double getFrameInterval();
+
+    QWidget *widget;
+    QTimer timer;
+    QElapsedTimer clock, frameClock;
+    qint64 lastFrameStart;
+    bool painting, pending;
+    int droppedFrames;
+};
+
+#endif // FRAMESCHEDULER_H
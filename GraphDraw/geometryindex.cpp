@@ -0,0 +1,225 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#include "GraphDraw/geometryindex.h"
+
+GeometryIndex::GeometryIndex()
+{
+    columns = rows = 0;
+
+    for(int kind = 0 ; kind < GEOMETRY_KINDS_NUM ; kind++)
+        grids << GeometryGrid();
+
+    reset(QSize(0, 0));
+}
+
+void GeometryIndex::reset(QSize size)
+{
+    gridSize = size;
+    columns = size.width() / INDEX_CELL_PX + 1;
+    rows = size.height() / INDEX_CELL_PX + 1;
+
+    for(int kind = 0 ; kind < GEOMETRY_KINDS_NUM ; kind++)
+        clear(GeometryKind(kind));
+}
+
+QSize GeometryIndex::getSize()
+{
+    return gridSize;
+}
+
+void GeometryIndex::clear(GeometryKind kind)
+{
+    GeometryGrid &grid = grids[int(kind)];
+
+    grid.objects.clear();
+    grid.objectsPos.clear();
+    grid.cells.fill(QVector<IndexedSegment>(), columns * rows);
+    grid.segmentsNum = 0;
+    grid.offset = QPoint();
+}
+
+void GeometryIndex::translate(QPoint shift)
+{
+    for(GeometryGrid &grid : grids)
+        grid.offset += shift;
+}
+
+int GeometryIndex::objectPos(GeometryGrid &grid, GeometryRef ref, bool points)
+{
+    auto pos = grid.objectsPos.constFind(qMakePair(ref.id, ref.kPos));
+
+    if(pos != grid.objectsPos.constEnd())
+        return *pos;
+
+    IndexedObject object;
+    object.ref = ref;
+    object.points = points;
+
+    grid.objects << object;
+    grid.objectsPos.insert(qMakePair(ref.id, ref.kPos), grid.objects.size() - 1);
+
+    return grid.objects.size() - 1;
+}
+
+void GeometryIndex::insert(GeometryGrid &grid, IndexedSegment segment, QRectF bounds)
+{
+    int firstColumn = qMax(0, int(floor(bounds.left() / INDEX_CELL_PX)));
+    int lastColumn = qMin(columns - 1, int(floor(bounds.right() / INDEX_CELL_PX)));
+    int firstRow = qMax(0, int(floor(bounds.top() / INDEX_CELL_PX)));
+    int lastRow = qMin(rows - 1, int(floor(bounds.bottom() / INDEX_CELL_PX)));
+
+    for(int row = firstRow ; row <= lastRow ; row++)
+        for(int column = firstColumn ; column <= lastColumn ; column++)
+            grid.cells[row * columns + column] << segment;
+
+    grid.segmentsNum++;
+}
+
+void GeometryIndex::addPolyline(GeometryKind kind, GeometryRef ref, const QPolygonF &polyline)
+{
+    GeometryGrid &grid = grids[int(kind)];
+
+    if(polyline.size() < 2 || grid.segmentsNum + polyline.size() > INDEX_MAX_SEGMENTS)
+        return;
+
+    // geometry added after a translation is stored in the coordinates the grid was built in
+
+    QPolygonF stored = polyline.translated(-grid.offset);
+
+    int object = objectPos(grid, ref, false);
+    grid.objects[object].polylines << stored;
+
+    IndexedSegment segment;
+    segment.object = object;
+    segment.polyline = grid.objects[object].polylines.size() - 1;
+
+    for(int i = 0 ; i < polyline.size() - 1 ; i++)
+    {
+        segment.vertex = i;
+        insert(grid, segment, QRectF(stored[i], stored[i+1]).normalized());
+    }
+}
+
+void GeometryIndex::addPoints(GeometryKind kind, GeometryRef ref, const QPolygonF &points)
+{
+    GeometryGrid &grid = grids[int(kind)];
+
+    if(points.isEmpty() || grid.segmentsNum + points.size() > INDEX_MAX_SEGMENTS)
+        return;
+
+    QPolygonF stored = points.translated(-grid.offset);
+
+    int object = objectPos(grid, ref, true);
+    grid.objects[object].polylines << stored;
+
+    IndexedSegment segment;
+    segment.object = object;
+    segment.polyline = grid.objects[object].polylines.size() - 1;
+
+    for(int i = 0 ; i < points.size() ; i++)
+    {
+        segment.vertex = i;
+        insert(grid, segment, QRectF(stored[i], QSizeF(0, 0)));
+    }
+}
+
+double GeometryIndex::distance(const GeometryGrid &grid, const IndexedSegment &segment, QPointF pos)
+{
+    const IndexedObject &object = grid.objects[segment.object];
+    const QPolygonF &polyline = object.polylines[segment.polyline];
+
+    QPointF a = polyline[segment.vertex];
+
+    if(object.points)
+        return QLineF(a, pos).length();
+
+    QPointF b = polyline[segment.vertex + 1];
+    QPointF ab = b - a;
+    double lengthSquared = QPointF::dotProduct(ab, ab);
+    double t = lengthSquared == 0 ? 0 : qBound(0.0, QPointF::dotProduct(pos - a, ab) / lengthSquared, 1.0);
+
+    return QLineF(a + t * ab, pos).length();
+}
+
+bool GeometryIndex::nearest(GeometryKind kind, QPointF pos, double radius, GeometryRef &ref, GeometryRef excluded)
+{
+    const GeometryGrid &grid = grids[int(kind)];
+
+    pos -= grid.offset;
+
+    int firstColumn = qMax(0, int(floor((pos.x() - radius) / INDEX_CELL_PX)));
+    int lastColumn = qMin(columns - 1, int(floor((pos.x() + radius) / INDEX_CELL_PX)));
+    int firstRow = qMax(0, int(floor((pos.y() - radius) / INDEX_CELL_PX)));
+    int lastRow = qMin(rows - 1, int(floor((pos.y() + radius) / INDEX_CELL_PX)));
+
+    double best = radius, dist;
+    int bestObject = -1;
+
+    for(int row = firstRow ; row <= lastRow ; row++)
+    {
+        for(int column = firstColumn ; column <= lastColumn ; column++)
+        {
+            for(const IndexedSegment &segment : grid.cells[row * columns + column])
+            {
+                const GeometryRef &candidate = grid.objects[segment.object].ref;
+
+                if(candidate.id == excluded.id && candidate.kPos == excluded.kPos)
+                    continue;
+
+                dist = distance(grid, segment, pos);
+
+                if(dist < best)
+                {
+                    best = dist;
+                    bestObject = segment.object;
+                }
+            }
+        }
+    }
+
+    if(bestObject == -1)
+        return false;
+
+    ref = grid.objects[bestObject].ref;
+    return true;
+}
+
+QList<QPolygonF> GeometryIndex::getGeometry(GeometryKind kind, GeometryRef ref, bool &points)
+{
+    // the indexed geometry, in current device pixels
+
+    const GeometryGrid &grid = grids[int(kind)];
+    QList<QPolygonF> polylines;
+
+    auto pos = grid.objectsPos.constFind(qMakePair(ref.id, ref.kPos));
+
+    if(pos == grid.objectsPos.constEnd())
+        return polylines;
+
+    points = grid.objects[*pos].points;
+
+    for(const QPolygonF &polyline : grid.objects[*pos].polylines)
+        polylines << polyline.translated(grid.offset);
+
+    return polylines;
+}
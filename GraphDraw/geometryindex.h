@@ -0,0 +1,89 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#ifndef GEOMETRYINDEX_H
+#define GEOMETRYINDEX_H
+
+#include <QtWidgets>
+
+#define INDEX_CELL_PX 16
+#define INDEX_MAX_SEGMENTS 4000000 // per kind, geometry beyond this is not indexed
+
+enum struct GeometryKind { Function, Sequence, Regression, ParEq, Data };
+#define GEOMETRY_KINDS_NUM 5
+
+struct GeometryRef
+{
+    int id, kPos;
+};
+
+struct IndexedSegment
+{
+    int object, polyline, vertex; // from vertex to vertex + 1, or the lone vertex for point objects
+};
+
+struct IndexedObject
+{
+    GeometryRef ref;
+    bool points;
+    QList<QPolygonF> polylines;
+};
+
+struct GeometryGrid
+{
+    QList<IndexedObject> objects;
+    QHash<QPair<int,int>, int> objectsPos;
+    QVector< QVector<IndexedSegment> > cells;
+    int segmentsNum;
+    QPoint offset; // shift of the drawn geometry since the grid was cleared
+};
+
+class GeometryIndex
+{
+    // Uniform grid over the geometry drawn in the graph, in device pixels, one grid per kind of object.
+    // Answers which object is the nearest to the cursor without evaluating anything.
+
+public:
+    GeometryIndex();
+
+    void reset(QSize size);
+    QSize getSize();
+    void clear(GeometryKind kind);
+    void translate(QPoint shift);
+
+    void addPolyline(GeometryKind kind, GeometryRef ref, const QPolygonF &polyline);
+    void addPoints(GeometryKind kind, GeometryRef ref, const QPolygonF &points);
+
+    bool nearest(GeometryKind kind, QPointF pos, double radius, GeometryRef &ref, GeometryRef excluded = GeometryRef{-1, -1});
+    QList<QPolygonF> getGeometry(GeometryKind kind, GeometryRef ref, bool &points);
+
+protected:
+    int objectPos(GeometryGrid &grid, GeometryRef ref, bool points);
+    void insert(GeometryGrid &grid, IndexedSegment segment, QRectF bounds);
+    double distance(const GeometryGrid &grid, const IndexedSegment &segment, QPointF pos);
+
+    QSize gridSize;
+    int columns, rows;
+    QList<GeometryGrid> grids;
+};
+
+#endif // GEOMETRYINDEX_H
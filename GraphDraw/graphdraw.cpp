@@ -27,7 +27,6 @@ GraphDraw::GraphDraw(Information *info)
 {
     information = info;
 
-    coef = sqrt(3)/2;
 
     setMinimumSize(QSize(200, 200));
     viewSettings = info->getViewSettings();
@@ -43,6 +42,8 @@ GraphDraw::GraphDraw(Information *info)
 
     moving = false;
     tangentDrawException = -1;
+    rasterizer = nullptr;
+    indexGeometry = false;
 
     funcValuesSaver = new FuncValuesSaver(info->getFuncsList(), viewSettings.graph.distanceBetweenPoints);
 
@@ -61,7 +62,7 @@ void GraphDraw::addRegSaver(Regression *reg)
 {
     regValuesSavers << RegressionValuesSaver(viewSettings.graph.distanceBetweenPoints, reg);
     recalculate = true;
-    repaint();
+    scheduleFrame();
 }
 
 void GraphDraw::delRegSaver(Regression *reg)
@@ -70,70 +71,33 @@ void GraphDraw::delRegSaver(Regression *reg)
         if(regValuesSavers[i].getRegression() == reg)
             regValuesSavers.removeAt(i);
     recalculate = false;
-    repaint();
-}
-
-void GraphDraw::drawRhombus(QPointF pt, double w)
-{   
-    QPolygonF polygon;
-    polygon << pt + QPointF(-w,0) << pt + QPointF(0,w) << pt + QPointF(w,0) << pt + QPointF(0,-w);
-
-    painter.drawPolygon(polygon);
-}
-
-void GraphDraw::drawDisc(QPointF pt, double w)
-{
-    painter.drawEllipse(pt, w, w);
-}
-
-void GraphDraw::drawSquare(QPointF pt, double w)
-{
-    painter.setRenderHint(QPainter::Antialiasing, false);
-
-    QRectF rect;
-    rect.setTopLeft(pt + QPointF(-w,-w));
-    rect.setBottomRight(pt + QPointF(w,w));
-
-    painter.drawRect(rect);
-}
-
-void GraphDraw::drawTriangle(QPointF pt, double w)
-{
-    w*=2;
-    QPolygonF polygon;
-    double d  = w*coef;
-    double b = w/2;
-
-    polygon << pt + QPointF(0, -w) << pt + QPointF(d, b) << pt + QPointF(-d,b);
-
-    painter.drawPolygon(polygon);
+    scheduleFrame();
 }
 
-void GraphDraw::drawCross(QPointF pt, double w)
+void GraphDraw::scheduleFrame()
 {
-    painter.setRenderHint(QPainter::Antialiasing, false);
-
-    pen.setWidth(w);
-
-    painter.drawLine(pt+QPointF(0,2*w), pt+QPointF(0, -2*w));
-    painter.drawLine(pt+QPointF(-2*w, 0), pt+QPointF(2*w, 0));
+    repaint();
 }
 
 void GraphDraw::drawDataSet(int id, int width)
 {
     QList<QPointF> list = information->getDataList(id);
     DataStyle style = information->getDataStyle(id);
+    int revision = information->getDataRevision(id);
 
 
     pen.setColor(style.color);
     painter.setPen(pen);
 
+    indexedKind = GeometryKind::Data;
+    indexedRef = GeometryRef{id, 0};
+
     if(style.drawLines)
     {
-        QPolygonF polygon;
         pen.setStyle(style.lineStyle);
         painter.setPen(pen);
-        painter.drawPolyline(polygon.fromList(list));
+        for(const QPolygonF &part : clipCurve(dataLines[revision].getPolyline(list, revision, painter.transform(), getPaintedArea())))
+            drawPolyline(part);
         pen.setStyle(Qt::SolidLine);
         painter.setPen(pen);
     }
@@ -141,27 +105,54 @@ void GraphDraw::drawDataSet(int id, int width)
     brush.setColor(style.color);
     painter.setBrush(brush);    
 
+    // data sets with far more points than pixels are drawn as a density map instead of markers
+
+    if(style.drawPoints && densityMaps[revision].draw(painter, list, revision, style.color))
+        return;
+
     if(style.drawPoints)
     {
+        // every point stamps the same pre-rendered marker, in device pixels, and points out of the painted area are skipped
+
+        const QPixmap &sprite = markerSprites.getSprite(style.pointStyle, width, style.color, viewSettings.graph.smoothing && !moving);
+        QRectF source(sprite.rect());
+
+        QTransform transform = painter.transform();
+        QRectF area = getPaintedArea();
+
+        double margin = sprite.width() / 2.0;
+        area.adjust(-margin, -margin, margin, margin);
+
+        QVector<QPainter::PixmapFragment> fragments;
+        fragments.reserve(qMin(list.size(), MARKER_BATCH_SIZE));
+        QPolygonF stamped;
+        QPointF pt;
+
+        painter.save();
+        painter.resetTransform();
+
         for(int i = 0 ; i < list.size() ; i++)
-            switch(style.pointStyle)
+        {
+            pt = transform.map(list[i]);
+
+            if(area.contains(pt))
             {
-            case PointStyle::Rhombus:
-                drawRhombus(list[i], width);
-                break;
-            case PointStyle::Disc:
-                drawDisc(list[i], width);
-                break;
-            case PointStyle::Square:
-                drawSquare(list[i], width);
-                break;
-            case PointStyle::Triangle:
-                drawTriangle(list[i], width);
-                break;
-            case PointStyle::Cross:
-                drawCross(list[i], width);
-                break;
+                fragments << QPainter::PixmapFragment::create(pt, source);
+                if(indexGeometry)
+                    stamped << pt;
+            }
+
+            if(fragments.size() == MARKER_BATCH_SIZE || (i == list.size() - 1 && !fragments.isEmpty()))
+            {
+                painter.drawPixmapFragments(fragments.constData(), fragments.size(), sprite);
+                fragments.clear();
             }
+        }
+
+        painter.restore();
+
+        if(indexGeometry)
+            geometryIndex.addPoints(GeometryKind::Data, indexedRef, stamped);
     }
 
 
@@ -169,11 +160,231 @@ void GraphDraw::drawDataSet(int id, int width)
 
 void GraphDraw::drawData()
 {
+    QList<int> revisions;
+
     for(int i = 0 ; i < information->getDataListsCount(); i++)
     {
+        revisions << information->getDataRevision(i);
+
         if(information->getDataStyle(i).draw)
             drawDataSet(i, viewSettings.graph.curvesThickness + 2);
     }
+
+    for(int revision : densityMaps.keys())
+    {
+        if(!revisions.contains(revision))
+            densityMaps.remove(revision);
+    }
+
+    for(int revision : dataLines.keys())
+    {
+        if(!revisions.contains(revision))
+            dataLines.remove(revision);
+    }
+}
+
+QRectF GraphDraw::getPaintedArea()
+{
+    // part of the painter's device that can be painted, in device pixels
+
+    QRectF area(0, 0, painter.device()->width(), painter.device()->height());
+
+    if(painter.hasClipping())
+        area &= painter.transform().mapRect(painter.clipBoundingRect());
+
+    return area;
+}
+
+QRectF GraphDraw::getClipRect()
+{
+    double xPadding = CLIP_PADDING_PX / uniteX;
+    double yPadding = CLIP_PADDING_PX / uniteY;
+
+    QRectF rect = clipViewRect.isNull() ? graphView->viewRect().normalized() : clipViewRect;
+
+    return rect.adjusted(-xPadding, -yPadding, xPadding, yPadding);
+}
+
+bool GraphDraw::clipSegment(QPointF &pt1, QPointF &pt2, const QRectF &rect)
+{
+    // Liang-Barsky clipping, pt1 and pt2 are replaced by the ends of the visible part of the segment
+
+    QPointF start(qBound(-CLIP_COORDINATE_LIMIT, pt1.x(), CLIP_COORDINATE_LIMIT), qBound(-CLIP_COORDINATE_LIMIT, pt1.y(), CLIP_COORDINATE_LIMIT));
+    QPointF end(qBound(-CLIP_COORDINATE_LIMIT, pt2.x(), CLIP_COORDINATE_LIMIT), qBound(-CLIP_COORDINATE_LIMIT, pt2.y(), CLIP_COORDINATE_LIMIT));
+
+    double dx = end.x() - start.x();
+    double dy = end.y() - start.y();
+
+    double p[4] = {-dx, dx, -dy, dy};
+    double q[4] = {start.x() - rect.left(), rect.right() - start.x(), start.y() - rect.top(), rect.bottom() - start.y()};
+
+    double tStart = 0, tEnd = 1, r;
+    int startEdge = -1, endEdge = -1;
+
+    for(int i = 0 ; i < 4 ; i++)
+    {
+        if(p[i] == 0)
+        {
+            if(q[i] < 0)
+                return false;
+        }
+        else
+        {
+            r = q[i] / p[i];
+
+            if(p[i] < 0)
+            {
+                if(r > tEnd)
+                    return false;
+                if(r > tStart)
+                {
+                    tStart = r;
+                    startEdge = i;
+                }
+            }
+            else
+            {
+                if(r < tStart)
+                    return false;
+                if(r < tEnd)
+                {
+                    tEnd = r;
+                    endEdge = i;
+                }
+            }
+        }
+    }
+
+    // the intersections are computed from the crossed edge, start + t * delta loses all precision with huge coordinates
+
+    auto pointOnEdge = [&](int edge) -> QPointF
+    {
+        if(edge < 2)
+        {
+            double x = edge == 0 ? rect.left() : rect.right();
+            return QPointF(x, start.y() + (x - start.x()) / dx * dy);
+        }
+        else
+        {
+            double y = edge == 2 ? rect.top() : rect.bottom();
+            return QPointF(start.x() + (y - start.y()) / dy * dx, y);
+        }
+    };
+
+    if(startEdge != -1)
+        pt1 = pointOnEdge(startEdge);
+    if(endEdge != -1)
+        pt2 = pointOnEdge(endEdge);
+
+    return true;
+}
+
+QList<QPolygonF> GraphDraw::clipCurve(const QPolygonF &curve)
+{
+    QList<QPolygonF> parts;
+    QRectF rect = getClipRect();
+
+    if(rect.contains(curve.boundingRect()))
+    {
+        parts << curve;
+        return parts;
+    }
+
+    QPolygonF part;
+    QPointF pt1, pt2;
+
+    for(int i = 1 ; i < curve.size() ; i++)
+    {
+        pt1 = curve[i-1];
+        pt2 = curve[i];
+
+        if(std::isnan(pt1.y()) || std::isnan(pt2.y()) || !clipSegment(pt1, pt2, rect))
+        {
+            if(part.size() > 1)
+                parts << part;
+            part.clear();
+        }
+        else
+        {
+            // the curve left the view and came back: the visible parts are not joined
+            if(!part.isEmpty() && part.last() != pt1)
+            {
+                if(part.size() > 1)
+                    parts << part;
+                part.clear();
+            }
+
+            if(part.isEmpty())
+                part << pt1;
+            part << pt2;
+        }
+    }
+
+    if(part.size() > 1)
+        parts << part;
+
+    return parts;
+}
+
+QPolygonF GraphDraw::decimateCurve(const QPolygonF &curve)
+{
+    // M4 reduction: consecutive vertices that fall in the same pixel column are replaced by the first,
+    // lowest, highest and last of them, in their original order. The drawn pixels stay the same as long
+    // as the abscissas are monotonic, parametric or unsorted polylines are drawn as they are.
+
+    int n = curve.size();
+
+    if(n <= 4 || n < 2 * fabs(curve.last().x() - curve.first().x()) * uniteX)
+        return curve;
+
+    bool increasing = true, decreasing = true;
+
+    for(int j = 1 ; j < n && (increasing || decreasing) ; j++)
+    {
+        increasing = increasing && curve[j-1].x() <= curve[j].x();
+        decreasing = decreasing && curve[j-1].x() >= curve[j].x();
+    }
+
+    if(!increasing && !decreasing)
+        return curve;
+
+    QPolygonF reduced;
+    reduced.reserve(qMin(n, 4 * int(fabs(curve.last().x() - curve.first().x()) * uniteX) + 8));
+
+    int i = 0, first, last, minPos, maxPos, lastAdded = -1;
+    double column;
+
+    auto add = [&](int pos)
+    {
+        if(pos != lastAdded)
+        {
+            reduced << curve[pos];
+            lastAdded = pos;
+        }
+    };
+
+    while(i < n)
+    {
+        column = floor(curve[i].x() * uniteX);
+        first = minPos = maxPos = i;
+
+        for(i++ ; i < n && floor(curve[i].x() * uniteX) == column ; i++)
+        {
+            if(curve[i].y() < curve[minPos].y())
+                minPos = i;
+            else if(curve[i].y() > curve[maxPos].y())
+                maxPos = i;
+        }
+
+        last = i - 1;
+
+        add(first);
+        add(qMin(minPos, maxPos));
+        add(qMax(minPos, maxPos));
+        add(last);
+    }
+
+    return reduced;
 }
 
 void GraphDraw::drawCurve(int width, QColor color, const QPolygonF &curve)
@@ -182,8 +393,37 @@ void GraphDraw::drawCurve(int width, QColor color, const QPolygonF &curve)
     pen.setColor(color);
     painter.setPen(pen);
 
-    painter.drawPolyline(curve);
+    for(const QPolygonF &part : clipCurve(curve))
+        drawPolyline(decimateCurve(part));
+
+}
+
+void GraphDraw::drawPolyline(const QPolygonF &polyline)
+{
+    if(indexGeometry)
+        geometryIndex.addPolyline(indexedKind, indexedRef, painter.transform().map(polyline));
+
+    if(rasterizer != nullptr)
+        rasterizer->addPolyline(polyline, painter.pen());
+    else painter.drawPolyline(polyline);
+}
+
+void GraphDraw::beginTiledRasterization()
+{
+    // vector devices (pdf, svg) keep their curves as paths, only images are rasterized in tiles
 
+    if(painter.device()->devType() == QInternal::Image)
+        rasterizer = new TiledRasterizer(&painter);
+}
+
+void GraphDraw::endTiledRasterization()
+{
+    if(rasterizer != nullptr)
+    {
+        rasterizer->render();
+        delete rasterizer;
+        rasterizer = nullptr;
+    }
 }
 
 void GraphDraw::drawCurve(int width, QColor color, const QList<QPolygonF> &curves)
@@ -195,6 +435,8 @@ void GraphDraw::drawCurve(int width, QColor color, const QList<QPolygonF> &curve
 void GraphDraw::drawRegressions()
 {
     painter.setRenderHint(QPainter::Antialiasing, viewSettings.graph.smoothing && !moving);
+    beginTiledRasterization();
+    indexedKind = GeometryKind::Regression;
 
     for(int reg = 0 ; reg < regValuesSavers.size() ; reg++)
     {
@@ -202,11 +444,14 @@ void GraphDraw::drawRegressions()
         {
             for(int curve = 0 ; curve < regValuesSavers[reg].getCurves().size() ; curve++)
             {
+                indexedRef = GeometryRef{reg, curve};
                 drawCurve(viewSettings.graph.curvesThickness, information->getRegression(reg)->getColor(),
                           regValuesSavers[reg].getCurves().at(curve));
             }
         }
     }
+
+    endTiledRasterization();
 }
 
 void GraphDraw::recalculateRegVals()
@@ -217,10 +462,18 @@ void GraphDraw::recalculateRegVals()
     }
 }
 
+void GraphDraw::recalculateParEqs()
+{
+    for(ParEqWidget *parEq : *parEqs)
+        parEq->setViewMapping(uniteX, uniteY, *graphView);
+}
+
 
 void GraphDraw::drawFunctions()
 {    
     painter.setRenderHint(QPainter::Antialiasing, viewSettings.graph.smoothing && !moving);
+    beginTiledRasterization();
+    indexedKind = GeometryKind::Function;
 
     for(int func = 0 ; func < funcs.size(); func++)
     {
@@ -228,63 +481,159 @@ void GraphDraw::drawFunctions()
             continue;
 
         for(int curve = 0 ; curve < funcValuesSaver->getFuncDrawsNum(func) ;  curve++)
-            drawCurve(viewSettings.graph.curvesThickness, funcs[func]->getColorSaver()->getColor(curve), funcValuesSaver->getCurve(func, curve));
+        {
+            indexedRef = GeometryRef{func, curve};
+            const CompactCurve &storedCurve = funcValuesSaver->getStoredCurve(func, curve);
+
+            for(int part = 0 ; part < storedCurve.getSegmentsNum() ; part++)
+            {
+                storedCurve.getSegment(part, segmentBuffer);
+                drawCurve(viewSettings.graph.curvesThickness, funcs[func]->getColorSaver()->getColor(curve), segmentBuffer);
+            }
+        }
     }
+
+    endTiledRasterization();
 }
 
-void GraphDraw::drawOneSequence(int i, int width)
+const QList<QPolygonF>& GraphDraw::getSequencePoints(int i)
 {
-    if(graphView->getXmax() <= seqs[0]->get_nMin() ||
-            trunc(graphView->getXmax()) <= graphView->getXmin() ||
-            !seqs[i]->getDrawState())
-        return;
+    // the terms are kept in view coordinates until the sequence or the view changes
+
+    SequencePoints &cache = seqPoints[i];
+    QRectF view = graphView->viewRect();
+
+    if(cache.revision == seqs[i]->getRevision() && cache.view == view && cache.uniteX == uniteX && cache.uniteY == uniteY)
+        return cache.points;
+
+    cache.revision = seqs[i]->getRevision();
+    cache.view = view;
+    cache.uniteX = uniteX;
+    cache.uniteY = uniteY;
+    cache.points = computeSequencePoints(i, graphView->getXmin(), graphView->getXmax());
+
+    return cache.points;
+}
+
+QList<QPolygonF> GraphDraw::computeSequencePoints(int i, double xMin, double xMax)
+{
+    // terms from xMin to xMax, in units. When several terms fall in the same pixel column, only the lowest
+    // and the highest ones are kept. Zoomed out, past the first SEQ_TERMS_PER_COLUMN terms of a column,
+    // the extrema of the rest come from the per block summaries of the stored terms. Past the stored terms,
+    // which are only reached through checkpoints, the rest of the column is skipped
+
+    QList<QPolygonF> terms;
+
+    double nStart = ceil(qMax(xMin, double(seqs[i]->get_nMin())));
+    double nEnd = floor(xMax);
+    double width = graphView->unitToViewX(xMax) - graphView->unitToViewX(xMin);
+
+    double result, x, y, yMin = 0, yMax = 0, columnX = 0, column, currentColumn, columnEnd, storedEnd, termMin, termMax;
+    int columnTerms = 0;
+    bool ok;
 
-     painter.setRenderHint(QPainter::Antialiasing, viewSettings.graph.smoothing && !moving);
-     pen.setWidth(width);
+    for(int k = 0 ; k < seqs[i]->getDrawsNum() ; k++)
+    {
+        QPolygonF points;
+        points.reserve(2 * int(qMax(0.0, qMin(nEnd - nStart + 1, width * uniteX + 2))));
 
-     QPointF point;
-     double posX;
+        currentColumn = nan("");
+        ok = true;
 
-     double viewXmin = graphView->viewRect().left();
-     double viewXmax = graphView->viewRect().right();
+        for(double n = nStart ; n <= nEnd ; n++)
+        {
+            result = seqs[i]->getSeqValue(n, ok, k);
 
-     double Xmin = graphView->getXmin();
-     double Xmax = graphView->getXmax();
+            if(!ok || std::isnan(result) || std::isinf(result))
+                break;
 
-     if(Xmin >  seqs[0]->get_nMin())
-         posX = viewXmin;
-     else posX = graphView->unitToViewX(seqs[0]->get_nMin());
+            x = graphView->unitToViewX(n);
+            y = graphView->unitToViewY(result);
+            column = floor(x * uniteX);
 
-     double step = 1;
+            if(column == currentColumn)
+            {
+                yMin = qMin(yMin, y);
+                yMax = qMax(yMax, y);
+
+                if(++columnTerms == SEQ_TERMS_PER_COLUMN) // jumps to the last term before the next column
+                {
+                    columnEnd = qMin(nEnd, ceil(graphView->viewToUnitX((column + 1) / uniteX)) - 1);
+                    storedEnd = qMin(columnEnd, double(seqs[i]->get_nMin()) + MAX_SAVED_SEQ_VALS);
+
+                    if(storedEnd > n && seqs[i]->getSeqExtrema(n + 1, storedEnd, k, termMin, termMax))
+                    {
+                        termMin = graphView->unitToViewY(termMin);
+                        termMax = graphView->unitToViewY(termMax);
+
+                        yMin = qMin(yMin, qMin(termMin, termMax));
+                        yMax = qMax(yMax, qMax(termMin, termMax));
+                        n = storedEnd;
+                    }
+
+                    if(n >= storedEnd) // otherwise a term isn't finite, the next ones are evaluated until it breaks the strip
+                        n = qMax(n, columnEnd);
+                }
+            }
+            else
+            {
+                if(!std::isnan(currentColumn))
+                {
+                    points << QPointF(columnX, yMin);
+                    if(yMax != yMin)
+                        points << QPointF(columnX, yMax);
+                }
+
+                currentColumn = column;
+                columnTerms = 1;
+                columnX = x;
+                yMin = yMax = y;
+            }
+        }
 
-     if(uniteX < 1)
-         step = 5 * trunc(1/uniteX);
+        if(!std::isnan(currentColumn))
+        {
+            points << QPointF(columnX, yMin);
+            if(yMax != yMin)
+                points << QPointF(columnX, yMax);
+        }
 
+        terms << points;
+    }
 
-     double result;
-     bool ok = true;
-     int end = seqs[i]->getDrawsNum();
+    return terms;
+}
 
-     ColorSaver *colorSaver = seqs[i]->getColorSaver();
+void GraphDraw::drawOneSequence(int i, int width)
+{
+    if(graphView->getXmax() <= seqs[i]->get_nMin() || !seqs[i]->getDrawState())
+        return;
+
+    painter.setRenderHint(QPainter::Antialiasing, viewSettings.graph.smoothing && !moving);
+    pen.setWidth(width);
+
+    // a strip drawn while panning only computes the terms it covers, the cache is for the whole view
 
+    QList<QPolygonF> stripPoints;
 
-     for(int k = 0; k < end; k++)
-     {
-         pen.setColor(colorSaver->getColor(k));
-         painter.setPen(pen);
+    if(!clipViewRect.isNull())
+    {
+        QRectF clip = getClipRect();
+        stripPoints = computeSequencePoints(i, graphView->viewToUnitX(clip.left()), graphView->viewToUnitX(clip.right()));
+    }
 
-         for(double pos = posX; pos < viewXmax; pos += step)
-         {
-             result = seqs[i]->getSeqValue(trunc(graphView->unitToViewX(pos)), ok, k);
+    const QList<QPolygonF> &points = clipViewRect.isNull() ? getSequencePoints(i) : stripPoints;
+    ColorSaver *colorSaver = seqs[i]->getColorSaver();
 
-             if(!ok  || !std::isnormal(result))
-                 return;
+    for(int k = 0; k < points.size(); k++)
+    {
+        pen.setColor(colorSaver->getColor(k));
+        painter.setPen(pen);
+        painter.drawPoints(points[k]);
 
-             point.setX(pos);
-             point.setY(result);
-             painter.drawPoint(point);
-         }
-     }
+        if(indexGeometry)
+            geometryIndex.addPoints(GeometryKind::Sequence, GeometryRef{i, k}, painter.transform().map(points[k]));
+    }
 }
 
 void GraphDraw::drawSequences()
@@ -376,6 +725,8 @@ void GraphDraw::drawStaticParEq()
     pen.setWidth(viewSettings.graph.curvesThickness);
     painter.setRenderHint(QPainter::Antialiasing, viewSettings.graph.smoothing && !moving);
     painter.setPen(pen);
+    beginTiledRasterization();
+    indexedKind = GeometryKind::ParEq;
 
     for(int i = 0; i < parEqs->size(); i++)
     {
@@ -389,6 +740,7 @@ void GraphDraw::drawStaticParEq()
         {
             pen.setColor(colorSaver->getColor(curve));
             painter.setPen(pen);
+            indexedRef = GeometryRef{i, curve};
 
             polygon.clear();
 
@@ -398,9 +750,12 @@ void GraphDraw::drawStaticParEq()
                 polygon << QPointF(graphView->unitToViewX(point.x), graphView->unitToViewY(point.y));
             }
 
-            painter.drawPolyline(polygon);
+            for(const QPolygonF &part : clipCurve(polygon))
+                drawPolyline(decimateCurve(part));
         }
     }
+
+    endTiledRasterization();
 }
 
 
@@ -30,7 +30,26 @@
 #include "Calculus/funcvaluessaver.h"
 #include "Calculus/regressionvaluessaver.h"
 #include "GraphDraw/graphview.h"
+#include "GraphDraw/tiledrasterizer.h"
+#include "GraphDraw/markersprites.h"
+#include "GraphDraw/densitymap.h"
+#include "GraphDraw/datalinelod.h"
+#include "GraphDraw/geometryindex.h"
+#include "GraphDraw/ticklabelcache.h"
 
+#define CLIP_PADDING_PX 8 // curves are clipped against the view enlarged by this margin, so pen caps stay hidden
+#define CLIP_COORDINATE_LIMIT 1E300
+#define MARKER_BATCH_SIZE 4096 // data point stamps sent to QPainter at once
+#define SEQ_TERMS_PER_COLUMN 16 // past this many terms in a pixel column, the rest of the column is read from the stored terms' summaries
+
+
+struct SequencePoints
+{
+    int revision = -1;
+    QRectF view;
+    double uniteX = 0, uniteY = 0;
+    QList<QPolygonF> points; // for each k, in view coordinates
+};
 
 class GraphDraw : public QWidget // Base class from math objects drawing
 {
@@ -46,16 +65,21 @@ protected slots:
 
 protected:
 
-    inline void drawRhombus(QPointF pt,double w);
-    inline void drawDisc(QPointF pt, double w);
-    inline void drawSquare(QPointF pt, double w);
-    inline void drawTriangle(QPointF pt, double w);
-    inline void drawCross(QPointF pt, double w);
-
+    virtual void scheduleFrame();
+    const QList<QPolygonF>& getSequencePoints(int i);
+    QList<QPolygonF> computeSequencePoints(int i, double xMin, double xMax);
     void drawOneSequence(int id, int width);
     void drawDataSet(int id, int width);
+    QRectF getClipRect();
+    QRectF getPaintedArea();
+    bool clipSegment(QPointF &pt1, QPointF &pt2, const QRectF &rect);
+    QList<QPolygonF> clipCurve(const QPolygonF &curve);
+    QPolygonF decimateCurve(const QPolygonF &curve);
     void drawCurve(int width, QColor color, const QPolygonF &curve);
     void drawCurve(int width, QColor color, const QList<QPolygonF> &curves);
+    void drawPolyline(const QPolygonF &polyline);
+    void beginTiledRasterization();
+    void endTiledRasterization();
     void drawOneTangent(int id);
 
     void drawFunctions();
@@ -67,6 +91,7 @@ protected:
     void drawStaticParEq();
 
     void recalculateRegVals();
+    void recalculateParEqs();
 
 
     int graphWidthPx, graphHeightPx;
@@ -77,16 +102,28 @@ protected:
     ZeViewSettings viewSettings;
 
     QPolygonF polygon;
+    QPolygonF segmentBuffer; // the stored function curves are decoded in it one part at a time
     QPen pen;
     QBrush brush;
     Point centre;
     ZeGraphView *graphView;
 
-    double coef;
+    MarkerSprites markerSprites;
+    TickLabelCache tickLabels;
+    QHash<int, DensityMap> densityMaps; // by data revision
+    QHash<int, DataLineLod> dataLines; // by data revision
+    QHash<int, SequencePoints> seqPoints; // by sequence id
+
+    GeometryIndex geometryIndex;
+    bool indexGeometry; // when true, the drawn geometry is recorded in geometryIndex
+    GeometryKind indexedKind;
+    GeometryRef indexedRef;
 
     double uniteX, uniteY;
     bool moving, recalculate, recalculateRegs;
     int tangentDrawException;
+    QRectF clipViewRect; // when not null, curves are only drawn within this part of the view
+    TiledRasterizer *rasterizer; // when not null, curves are queued in it instead of being drawn right away
 
     QList<FuncCalculator*> funcs;
     QList<SeqCalculator*> seqs;
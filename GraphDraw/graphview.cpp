@@ -10,10 +10,12 @@ ZeGraphView::ZeGraphView(const ZeViewSettings &viewSettings, QSize widgetSize, Q
 void ZeGraphView::setViewSettings(const ZeViewSettings &viewSettings)
 {
     axesSettings = viewSettings.axes;
-    xLogBase = pow(axesSettings.x.base, double(axesSettings.x.basePowNum)/double(axesSettings.x.basePowDenom));
-    yLogBase = pow(axesSettings.y.base, double(axesSettings.y.basePowNum)/double(axesSettings.y.basePowDenom));
+    xLogBase = pow(axesSettings.x.whenLog.base, double(axesSettings.x.whenLog.basePowNum)/double(axesSettings.x.whenLog.basePowDenom));
+    yLogBase = pow(axesSettings.y.whenLog.base, double(axesSettings.y.whenLog.basePowNum)/double(axesSettings.y.whenLog.basePowDenom));
+    updateTransforms();
 
     gridSettings = viewSettings.grid;
+    graphFont = viewSettings.graph.graphFont;
 
     setGraphRange(viewSettings.range);
 }
@@ -28,18 +30,7 @@ void ZeGraphView::setGraphRange(const GraphRange &range)
 
 ZeGraphView::ZeGraphView(const ZeGraphView &other, QObject *parent) : QObject(parent)
 {
-    Xmin = other.Xmin;
-    Xmax = other.Xmax;
-    Ymin = other.Ymin;
-    Ymax = other.Ymax;
-
-    lgXmin = other.lgXmin;
-    lgXmax = other.lgXmax;
-    lgYmin = other.lgYmin;
-    lgYmax = other.lgYmax;
-
-    xLogBase = other.xLogBase;
-    yLogBase = other.yLogBase;
+    *this = other;
 }
 
 ZeGraphView& ZeGraphView::operator=(const ZeGraphView &other)
@@ -57,9 +48,32 @@ ZeGraphView& ZeGraphView::operator=(const ZeGraphView &other)
     xLogBase = other.xLogBase;
     yLogBase = other.yLogBase;
 
+    xGridStep = other.xGridStep;
+    yGridStep = other.yGridStep;
+
+    viewPxSize = other.viewPxSize;
+    axesSettings = other.axesSettings;
+    gridSettings = other.gridSettings;
+    graphFont = other.graphFont;
+
+    updateTransforms();
+
     return *this;
 }
 
+void ZeGraphView::updateTransforms()
+{
+    // the axis type and the logarithm of the bases are looked up once here, not at every transformed point
+
+    xLog = axesSettings.x.axisType == ZeAxisType::LOG;
+    yLog = axesSettings.y.axisType == ZeAxisType::LOG;
+
+    xLogBaseLn = log(xLogBase);
+    yLogBaseLn = log(yLogBase);
+    xLogBaseInv = 1 / xLogBaseLn;
+    yLogBaseInv = 1 / yLogBaseLn;
+}
+
 QRectF ZeGraphView::rect() const
 {
     QRectF graphWin;
@@ -170,7 +184,7 @@ void ZeGraphView::zoomView(QPointF center, double ratio)
             setXmin(Xmin - (Xmin - center.x())*ratio);
         }
 
-        if(axesSettings.x.axisType == ZeAxisType::LOG)
+        if(axesSettings.y.axisType == ZeAxisType::LOG)
         {
             setlgYmax(lgYmax - (lgYmax - center.y())*ratio);
             setlgYmin(lgYmin - (lgYmin - center.y())*ratio);
@@ -183,45 +197,318 @@ void ZeGraphView::zoomView(QPointF center, double ratio)
     }
 }
 
+void ZeGraphView::setViewPxSize(QSizeF size)
+{
+    viewPxSize = size;
+}
+
 ZeAxesTicks ZeGraphView::getAxesTicks()
 {
     ZeAxesTicks axesTicks;
 
-    if(viewPxSize.isNull())
+    if(viewPxSize.isEmpty())
         return axesTicks;
 
-    if(axesSettings.x.axisType == ZeAxisType::LINEAR)
+    QRectF view = viewRect();
+    QFontMetricsF metrics(graphFont);
+
+    // the x ticks are spaced according to the number of digits of their labels, so the spacing
+    // doesn't change while the view is translated, and the y ones according to the height of a line
+
+    int digitsNum = qMax(QString::number(Xmin, 'g', NUM_PREC).size(), QString::number(Xmax, 'g', NUM_PREC).size());
+    double xSpacing = metrics.width(QString(digitsNum, '0')) + TICK_LABEL_PADDING_PX;
+    double ySpacing = qMax(double(MIN_TICK_SPACING_PX), 2 * metrics.height());
+
+    axesTicks.x = getAxisTicks(xLattice, viewPxSize.width(), ZeAxisRange{view.left(), view.right()},
+                               axesSettings.x, gridSettings.alongX, xSpacing);
+    axesTicks.y = getAxisTicks(yLattice, viewPxSize.height(), ZeAxisRange{qMin(view.top(), view.bottom()), qMax(view.top(), view.bottom())},
+                               axesSettings.y, gridSettings.alongY, ySpacing);
+
+    return axesTicks;
+}
+
+ZeAxisTicks ZeGraphView::getAxisTicks(ZeTickLattice &lattice, double pxLength, ZeAxisRange viewRange, const ZeAxisSettings &axisSettings,
+                                      const ZeUnidimGridSettings &grid, double minSpacing)
+{
+    double amplitude = viewRange.max - viewRange.min;
+
+    if(!(amplitude > 0) || std::isinf(amplitude) || std::isnan(viewRange.min))
     {
+        lattice.valid = false;
+        return ZeAxisTicks();
+    }
+
+    ZeTickLatticeKey key;
+    key.axisType = axisSettings.axisType;
+    key.pxPerView = pxLength / amplitude;
+    key.minSpacing = minSpacing;
+    key.constantMultiplier = axisSettings.axisType == ZeAxisType::LOG ? axisSettings.whenLog.constantMultiplier : axisSettings.whenLinear.constantMultiplier;
+    key.base = axisSettings.whenLog.base;
+    key.multiplier = axisSettings.whenLinear.multiplier;
+    key.basePowNum = axisSettings.axisType == ZeAxisType::LOG ? axisSettings.whenLog.basePowNum : axisSettings.whenLinear.basePowNum;
+    key.basePowDenom = axisSettings.whenLog.basePowDenom;
+    key.subDivs = grid.subgridSubDivs;
+    key.showSubGrid = grid.showSubGrid;
+
+    if(!lattice.valid || !(lattice.key == key))
+    {
+        lattice.key = key;
+
+        if(key.axisType == ZeAxisType::LOG)
+            chooseLogLattice(lattice, axisSettings.whenLog);
+        else chooseLinearLattice(lattice, axisSettings.whenLinear);
 
+        lattice.valid = true;
+        lattice.ticks = ZeAxisTicks();
+        lattice.firstIndex = 0;
+        lattice.lastIndex = -1;
     }
 
-    return axesTicks;
+    double first = ceil((viewRange.min - lattice.origin) / lattice.step);
+    double last = floor((viewRange.max - lattice.origin) / lattice.step);
+
+    if(fabs(first) > 1E15 || fabs(last) > 1E15 || last - first > pxLength)
+    {
+        lattice.valid = false;
+        return ZeAxisTicks();
+    }
+
+    long firstIndex = long(first), lastIndex = long(last);
+
+    QList<ZeAxisTick> &ticks = lattice.ticks.ticks;
+    QList<ZeAxisSubTick> &subTicks = lattice.ticks.axisSubticks;
+
+    // the ticks and the sub ticks of the intervals around them that are still in the view are kept,
+    // only the ones that entered it are computed
+
+    if(ticks.isEmpty() || firstIndex > lattice.lastIndex || lastIndex < lattice.firstIndex)
+    {
+        ticks.clear();
+        subTicks.clear();
+        addSubTicks(subTicks, lattice, firstIndex - 1);
+
+        lattice.firstIndex = firstIndex;
+        lattice.lastIndex = firstIndex - 1;
+    }
+
+    for( ; lattice.firstIndex < firstIndex ; lattice.firstIndex++)
+        ticks.removeFirst();
+
+    for( ; lattice.lastIndex > lastIndex ; lattice.lastIndex--)
+        ticks.removeLast();
+
+    double subTicksStart = lattice.origin + double(firstIndex - 1) * lattice.step;
+    double subTicksEnd = lattice.origin + double(lastIndex + 1) * lattice.step;
+
+    while(!subTicks.isEmpty() && subTicks.first().pos < subTicksStart)
+        subTicks.removeFirst();
+
+    while(!subTicks.isEmpty() && subTicks.last().pos > subTicksEnd)
+        subTicks.removeLast();
+
+    for( ; lattice.firstIndex > firstIndex ; lattice.firstIndex--)
+    {
+        QList<ZeAxisSubTick> intervalSubTicks;
+        addSubTicks(intervalSubTicks, lattice, lattice.firstIndex - 2);
+
+        ticks.prepend(getTick(lattice, axisSettings, lattice.firstIndex - 1));
+        subTicks = intervalSubTicks + subTicks;
+    }
+
+    for( ; lattice.lastIndex < lastIndex ; lattice.lastIndex++)
+    {
+        ticks.append(getTick(lattice, axisSettings, lattice.lastIndex + 1));
+        addSubTicks(subTicks, lattice, lattice.lastIndex + 1);
+    }
+
+    updateOffset(lattice, viewRange);
+
+    return lattice.ticks;
 }
 
+void ZeGraphView::chooseLinearLattice(ZeTickLattice &lattice, const ZeLinAxisSettings &settings)
+{
+    // ticks are spaced by the smallest of 1, 2 or 5 times a power of ten, times the multiplier and the
+    // constant of the settings, that leaves at least the minimal spacing between them
+
+    double constant = settings.constantMultiplier > 0 ? settings.constantMultiplier : 1;
+    long multiplier = qMax(1, settings.multiplier);
+
+    double unit = constant * double(multiplier);
+    double smallestStep = lattice.key.minSpacing / lattice.key.pxPerView / unit;
 
-ZeAxisTicks ZeGraphView::getLinearAxisTicks(int pxWidth, ZeAxisRange range, ZeAxisSettings &axisSettings, QFontMetrics metrics)
+    int power = int(floor(log10(smallestStep)));
+    double mantissa = smallestStep / pow(10, power);
+
+    long stepMultiplier = 1;
+
+    if(mantissa > 5)
+        power++;
+    else if(mantissa > 2)
+        stepMultiplier = 5;
+    else if(mantissa > 1)
+        stepMultiplier = 2;
+
+    lattice.origin = 0;
+    lattice.stepMultiplier = stepMultiplier * multiplier;
+    lattice.stepPower = power;
+    lattice.step = unit * double(stepMultiplier) * pow(10, power);
+}
+
+void ZeGraphView::chooseLogLattice(ZeTickLattice &lattice, const ZeLogAxisSettings &settings)
 {
+    // a view unit is a power of the axis' base, ticks are put on the constant multiplier times every
+    // 1, 2, 5, 10, 20... powers, the smallest stride that leaves the minimal spacing between them
+
+    double base = settings.base > 1 ? settings.base : 10;
+    int num = settings.basePowNum != 0 ? settings.basePowNum : 1;
+    int denom = settings.basePowDenom > 0 ? settings.basePowDenom : 1;
+    double constant = settings.constantMultiplier > 0 ? settings.constantMultiplier : 1;
+
+    lattice.origin = log(constant) / (log(base) * double(num) / double(denom));
+
+    double smallestStride = lattice.key.minSpacing / lattice.key.pxPerView;
+    long stride = 1;
+
+    if(smallestStride > 1)
+    {
+        int power = int(floor(log10(smallestStride)));
+        double mantissa = smallestStride / pow(10, power);
+
+        stride = long(pow(10, power));
+
+        if(mantissa > 5)
+            stride *= 10;
+        else if(mantissa > 2)
+            stride *= 5;
+        else if(mantissa > 1)
+            stride *= 2;
+    }
+
+    lattice.stepMultiplier = stride;
+    lattice.stepPower = 0;
+    lattice.step = double(stride);
+}
 
-    ZeAxisTicks axisTicks;
+ZeAxisTick ZeGraphView::getTick(const ZeTickLattice &lattice, const ZeAxisSettings &axisSettings, long index)
+{
+    ZeAxisTick tick;
 
-    int smallestBasePower = int(floor(log10(range.amplitude())) - 1);
+    tick.pos = lattice.origin + double(index) * lattice.step;
+    tick.subMultiplier = 0;
 
-    if(smallestBasePower <= axisSettings.whenLog.basePowNum and axisSettings.whenLog.basePowNum <= smallestBasePower + 2)
+    if(lattice.key.axisType == ZeAxisType::LOG)
     {
-        // The current settings may be good enough to use as is
+        const ZeLogAxisSettings &settings = axisSettings.whenLog;
 
+        tick.base = settings.base > 1 ? settings.base : 10;
+        tick.baseStr = settings.baseStr;
+        tick.globalConstant = settings.constantMultiplier > 0 ? settings.constantMultiplier : 1;
+        tick.globalConstantStr = settings.constantMultiplierStr;
+        tick.multiplier = 1;
+        tick.powerNumerator = index * lattice.stepMultiplier * (settings.basePowNum != 0 ? settings.basePowNum : 1);
+        tick.powerDenominator = settings.basePowDenom > 0 ? settings.basePowDenom : 1;
+        tick.value = tick.globalConstant * pow(tick.base, double(tick.powerNumerator) / double(tick.powerDenominator));
     }
     else
     {
-        // Redo entirely the tick calculations
+        const ZeLinAxisSettings &settings = axisSettings.whenLinear;
+
+        tick.base = 10;
+        tick.baseStr = "10";
+        tick.globalConstant = settings.constantMultiplier > 0 ? settings.constantMultiplier : 1;
+        tick.globalConstantStr = settings.constantMultiplierStr;
+        tick.multiplier = index * lattice.stepMultiplier;
+        tick.powerNumerator = lattice.stepPower;
+        tick.powerDenominator = 1;
+        tick.value = tick.pos;
+    }
+
+    return tick;
+}
+
+void ZeGraphView::addSubTicks(QList<ZeAxisSubTick> &subTicks, const ZeTickLattice &lattice, long index)
+{
+    // sub ticks of the interval between the ticks index and index + 1
+
+    if(!lattice.key.showSubGrid)
+        return;
+
+    ZeAxisSubTick subTick;
+    double intervalStart = lattice.origin + double(index) * lattice.step;
+
+    bool logDecades = lattice.key.axisType == ZeAxisType::LOG && lattice.stepMultiplier == 1 && lattice.key.basePowNum == lattice.key.basePowDenom &&
+                      lattice.key.base >= 3 && lattice.key.base == floor(lattice.key.base);
+
+    if(logDecades)
+    {
+        // 2, 3... base-1 times the power, like on log paper
+
+        subTick.denominator = 1;
+
+        for(int j = 2 ; j < int(lattice.key.base) ; j++)
+        {
+            subTick.numerator = j;
+            subTick.pos = intervalStart + log(j) / log(lattice.key.base);
+            subTicks << subTick;
+        }
+    }
+    else if(lattice.key.subDivs > 1)
+    {
+        subTick.denominator = int(lattice.key.subDivs);
+
+        for(int j = 1 ; j < int(lattice.key.subDivs) ; j++)
+        {
+            subTick.numerator = j;
+            subTick.pos = intervalStart + lattice.step * double(j) / double(lattice.key.subDivs);
+            subTicks << subTick;
+        }
     }
+}
 
-    QList<long> multipliers;
-    double ticksNum = range.amplitude() / 10;
+void ZeGraphView::updateOffset(ZeTickLattice &lattice, ZeAxisRange viewRange)
+{
+    // far from zero, linear labels are written relatively to an offset rounded enough
+    // to stay the same while the view moves by a few ticks
 
-    double tickDistance = double(pxWidth) / ticksNum;
+    ZeOffset &offset = lattice.ticks.offset;
 
-    return axisTicks;
+    offset.sumOffset = 0;
+    offset.powerOffset = 0;
+
+    if(lattice.key.axisType == ZeAxisType::LOG)
+        return;
+
+    double center = (viewRange.min + viewRange.max) / 2 / lattice.step;
+
+    if(fabs(center) < LABEL_OFFSET_THRESHOLD)
+        return;
+
+    double span = double(lattice.lastIndex - lattice.firstIndex + 1) * double(lattice.stepMultiplier);
+    double rounding = pow(10, ceil(log10(qMax(span, 1.0))));
+
+    offset.sumOffset = long(round(center * double(lattice.stepMultiplier) / rounding) * rounding);
+    offset.powerOffset = lattice.stepPower;
+}
+
+double ZeGraphView::tickLabelValue(const ZeAxisTick &tick, const ZeOffset &offset)
+{
+    // the offset is taken from the integer multiplier, so the digits telling the ticks apart are kept
+
+    if(offset.sumOffset == 0)
+        return tick.value;
+
+    return tick.globalConstant * double(tick.multiplier - offset.sumOffset) * pow(10, tick.powerNumerator);
+}
+
+double ZeGraphView::offsetValue(const ZeAxisTicks &axisTicks)
+{
+    // value to add to the labels of the axis, 0 when they are written as they are
+
+    if(axisTicks.offset.sumOffset == 0 || axisTicks.ticks.isEmpty())
+        return 0;
+
+    return axisTicks.ticks.first().globalConstant * double(axisTicks.offset.sumOffset) * pow(10, axisTicks.offset.powerOffset);
 }
 
 void ZeGraphView::translateView(QPointF vec)
@@ -249,28 +536,14 @@ void ZeGraphView::translateView(QPointF vec)
     }
 }
 
-double ZeGraphView::viewToUnitY(double viewY) const // viewY =
+double ZeGraphView::viewToUnitY(double viewY) const
 {
-    if(axesSettings.x.axisType == ZeAxisType::LOG)
-    {
-        return pow(yLogBase, viewY);
-    }
-    else
-    {
-        return viewY;
-    }
+    return yLog ? exp(viewY * yLogBaseLn) : viewY;
 }
 
 double ZeGraphView::unitToViewY(double unitY) const
 {
-    if(axesSettings.y.axisType == ZeAxisType::LOG)
-    {
-        return log(unitY)/log(yLogBase);
-    }
-    else
-    {
-        return unitY;
-    }
+    return yLog ? log(unitY) * yLogBaseInv : unitY;
 }
 
 double ZeGraphView::getXmin()
@@ -295,26 +568,58 @@ double ZeGraphView::getYmax()
 
 double ZeGraphView::viewToUnitX(double viewX) const
 {
-    if(axesSettings.x.axisType == ZeAxisType::LOG)
+    return xLog ? exp(viewX * xLogBaseLn) : viewX;
+}
+
+double ZeGraphView::unitToViewX(double unitX) const
+{
+    return xLog ? log(unitX) * xLogBaseInv : unitX;
+}
+
+// batch versions, the axis type is checked once for the whole array, which may be transformed in place
+
+void ZeGraphView::viewToUnitX(const double *viewX, double *unitX, int n) const
+{
+    if(xLog)
     {
-        return pow(xLogBase, viewX);
+        for(int i = 0 ; i < n ; i++)
+            unitX[i] = exp(viewX[i] * xLogBaseLn);
     }
-    else
+    else if(unitX != viewX)
+        std::copy(viewX, viewX + n, unitX);
+}
+
+void ZeGraphView::unitToViewX(const double *unitX, double *viewX, int n) const
+{
+    if(xLog)
     {
-        return viewX;
+        for(int i = 0 ; i < n ; i++)
+            viewX[i] = log(unitX[i]) * xLogBaseInv;
     }
+    else if(unitX != viewX)
+        std::copy(unitX, unitX + n, viewX);
 }
 
-double ZeGraphView::unitToViewX(double unitX) const
+void ZeGraphView::viewToUnitY(const double *viewY, double *unitY, int n) const
 {
-    if(axesSettings.x.axisType == ZeAxisType::LOG)
+    if(yLog)
     {
-        return log(unitX)/log(xLogBase);
+        for(int i = 0 ; i < n ; i++)
+            unitY[i] = exp(viewY[i] * yLogBaseLn);
     }
-    else
+    else if(unitY != viewY)
+        std::copy(viewY, viewY + n, unitY);
+}
+
+void ZeGraphView::unitToViewY(const double *unitY, double *viewY, int n) const
+{
+    if(yLog)
     {
-        return unitX;
+        for(int i = 0 ; i < n ; i++)
+            viewY[i] = log(unitY[i]) * yLogBaseInv;
     }
+    else if(unitY != viewY)
+        std::copy(unitY, unitY + n, viewY);
 }
 
 void ZeGraphView::setViewXmin(double val)
@@ -389,47 +694,47 @@ void ZeGraphView::verifyOrthonormality()
 void ZeGraphView::setlgXmin(double val)
 {
     lgXmin = val;
-    Xmin = pow(xLogBase, lgXmin);
+    Xmin = exp(lgXmin * xLogBaseLn);
 }
 
 void ZeGraphView::setlgXmax(double val)
 {
     lgXmax = val;
-    Xmax = pow(xLogBase, lgXmax);
+    Xmax = exp(lgXmax * xLogBaseLn);
 }
 
 void ZeGraphView::setlgYmin(double val)
 {
     lgYmin = val;
-    Ymin = pow(yLogBase, lgYmin);
+    Ymin = exp(lgYmin * yLogBaseLn);
 }
 
 void ZeGraphView::setlgYmax(double val)
 {
     lgYmax = val;
-    Ymax = pow(yLogBase, lgYmax);
+    Ymax = exp(lgYmax * yLogBaseLn);
 }
 
 void ZeGraphView::setXmin(double val)
 {
     Xmin = val;
-    lgXmin = log(Xmin)/log(xLogBase);
+    lgXmin = log(Xmin) * xLogBaseInv;
 }
 
 void ZeGraphView::setXmax(double val)
 {
     Xmax = val;
-    lgXmax = log(Xmax)/log(xLogBase);
+    lgXmax = log(Xmax) * xLogBaseInv;
 }
 
 void ZeGraphView::setYmin(double val)
 {
     Ymin = val;
-    lgYmin = log(Ymin)/log(yLogBase);
+    lgYmin = log(Ymin) * yLogBaseInv;
 }
 
 void ZeGraphView::setYmax(double val)
 {
     Ymax = val;
-    lgYmax = log(Ymax)/log(yLogBase);
+    lgYmax = log(Ymax) * yLogBaseInv;
 }
@@ -25,12 +25,17 @@
 #include <QWidget>
 #include <QRectF>
 #include <QPair>
+#include <QFontMetricsF>
 
 #include "structures.h"
 
+#define MIN_TICK_SPACING_PX 25 // between two consecutive ticks of the y axis
+#define TICK_LABEL_PADDING_PX 32 // added to the widest x label to space the ticks of the x axis
+#define LABEL_OFFSET_THRESHOLD 100000 // ticks further from zero than this many steps get labelled relatively to an offset
+
 struct ZeAxisTick
 {
-    double pos;
+    double pos, value; // in view coordinates and in units
     QString baseStr, globalConstantStr;
     double base, globalConstant;
     long multiplier, subMultiplier, powerNumerator, powerDenominator;
@@ -59,6 +64,39 @@ struct ZeAxesTicks
     ZeAxisTicks x, y;
 };
 
+struct ZeTickLatticeKey
+{
+    ZeAxisType axisType;
+    double pxPerView, minSpacing, constantMultiplier, base;
+    int multiplier, basePowNum, basePowDenom;
+    unsigned int subDivs;
+    bool showSubGrid;
+
+    bool operator==(const ZeTickLatticeKey &other) const
+    {
+        // translating the view changes its amplitude by rounding errors only
+
+        return axisType == other.axisType && fabs(pxPerView - other.pxPerView) <= 1E-9 * fabs(pxPerView) && minSpacing == other.minSpacing &&
+                constantMultiplier == other.constantMultiplier && base == other.base && multiplier == other.multiplier &&
+                basePowNum == other.basePowNum && basePowDenom == other.basePowDenom && subDivs == other.subDivs &&
+                showSubGrid == other.showSubGrid;
+    }
+};
+
+struct ZeTickLattice
+{
+    // ticks sit at origin + index * step in view coordinates. As long as the key doesn't change,
+    // the view can only have been translated and the ticks are shifted instead of computed again
+
+    bool valid = false;
+    ZeTickLatticeKey key;
+    double origin, step;
+    long stepMultiplier; // linear: multiplier between two consecutive ticks, log: powers between them
+    int stepPower;
+    long firstIndex, lastIndex;
+    ZeAxisTicks ticks;
+};
+
 
 class ZeGraphView : public QObject
 {
@@ -105,7 +143,15 @@ public:
     double viewToUnitX(double viewX) const ;
     double unitToViewX(double unitX) const ;
 
+    void viewToUnitX(const double *viewX, double *unitX, int n) const;
+    void unitToViewX(const double *unitX, double *viewX, int n) const;
+    void viewToUnitY(const double *viewY, double *unitY, int n) const;
+    void unitToViewY(const double *unitY, double *viewY, int n) const;
+
     ZeAxesTicks getAxesTicks();
+    static double tickLabelValue(const ZeAxisTick &tick, const ZeOffset &offset);
+    static double offsetValue(const ZeAxisTicks &axisTicks);
+    void setViewPxSize(QSizeF size);
 
     QRectF rect() const ;
     QRectF lgRect() const ;
@@ -117,20 +163,32 @@ signals:
 public slots:
 
 protected:
-    ZeAxisTicks getLinearAxisTicks(int pxWidth, ZeAxisRange range, ZeAxisSettings &axisSettings, QFontMetrics metrics);
+    ZeAxisTicks getAxisTicks(ZeTickLattice &lattice, double pxLength, ZeAxisRange viewRange, const ZeAxisSettings &axisSettings,
+                             const ZeUnidimGridSettings &grid, double minSpacing);
+    void chooseLinearLattice(ZeTickLattice &lattice, const ZeLinAxisSettings &settings);
+    void chooseLogLattice(ZeTickLattice &lattice, const ZeLogAxisSettings &settings);
+    ZeAxisTick getTick(const ZeTickLattice &lattice, const ZeAxisSettings &axisSettings, long index);
+    void addSubTicks(QList<ZeAxisSubTick> &subTicks, const ZeTickLattice &lattice, long index);
+    void updateOffset(ZeTickLattice &lattice, ZeAxisRange viewRange);
 
     void verifyOrthonormality();
+    void updateTransforms();
 
     double Xmin, Xmax, Ymin, Ymax;
     double lgXmin, lgXmax, lgYmin, lgYmax;
 
     double xLogBase, yLogBase;    
+    double xLogBaseLn, yLogBaseLn, xLogBaseInv, yLogBaseInv;
+    bool xLog, yLog;
     double xGridStep, yGridStep;
 
     QSizeF viewPxSize;
 
     ZeAxesSettings axesSettings;
     ZeGridSettings gridSettings;
+    QFont graphFont;
+
+    ZeTickLattice xLattice, yLattice; // not copied, each view keeps the ticks it computed
 };
 
 #endif // GRAPHVIEW_H
@@ -221,10 +221,9 @@ void ImagePreview::writeLegends()
 
 void ImagePreview::drawTicksAndNumbers()
 {
-    // TODO: update this method
+    // same tick engine as the main graph, for the size of the exported graph
 
     double fontSize = information->getGraphSettings().graphFont.pixelSize();
-    double prec = numPrec;
 
     font.setPixelSize(fontSize);
     font.setItalic(false);
@@ -235,104 +234,93 @@ void ImagePreview::drawTicksAndNumbers()
     painter.setFont(viewSettings.graph.graphFont);
     painter.setRenderHint(QPainter::Antialiasing, false);
 
-    QFontMetrics fontMetrics = painter.fontMetrics();
+    ZeAxesTicks axesTicks = graphView->getAxesTicks();
+    const ZeGridSettings &grid = viewSettings.grid;
 
     double space, pos;
 
-
-
-    double Xpos;
-
-    ZeGrid grid = graphView.getGrid();
-
-    QList<ZeMainGridLine> &horMainGrid = grid.horizontal.mainGrid;
-
-
-    QString num;
-
-    for(ZeMainGridLine gridLine: horMainGrid)
+    for(const ZeAxisTick &tick : axesTicks.x.ticks)
     {
-        Xpos = gridLine.pos;
+        pos = centre.x + tick.pos * uniteX;
 
-        if(fabs(Xpos) > 1)
-        {
-            if(graphSettings.gridSettings.gridType == ZeGridType::GRID)
-            {
-                pen.setColor(graphSettings.gridColor);
-                pen.setWidthF(0.5);
-                painter.setPen(pen);
-                painter.drawLine(QPointF(Xpos + centre.x, 0), QPointF(Xpos + centre.x, graphRectScaled.height()));
-            }
-            pen.setColor(graphSettings.axesColor);
+        if(pos < 0 || pos > graphRectScaled.width())
+            continue;
 
+        if(grid.alongX.showGrid && fabs(pos - centre.x) > 1)
+        {
+            pen.setColor(grid.alongX.gridColor);
+            pen.setWidthF(grid.alongX.gridLineWidth);
             painter.setPen(pen);
+            painter.drawLine(QPointF(pos, 0), QPointF(pos, graphRectScaled.height()));
+        }
 
-            pos = Xpos + centre.x;
+        pen.setColor(viewSettings.axes.x.color);
+        pen.setWidth(1);
+        painter.setPen(pen);
 
-            painter.drawLine(QPointF(pos, 4), QPointF(pos, 0));
-            painter.drawLine(QPointF(pos, graphRectScaled.height()-4), QPointF(pos, graphRectScaled.height()));
-            num = QString::number(Xpos/uniteX, 'g', numPrec);
-            space = fontMetrics.width(num);
-            painter.drawText(QPointF(pos - space/2, graphRectScaled.height()+15), num);
-        }
-        else
-        {
-            pos = Xpos + centre.x;
-            space = fontMetrics.width("0");
-            painter.drawText(QPointF(pos - space/2, graphRectScaled.height()+15), "0");
-        }
+        painter.drawLine(QPointF(pos, 4), QPointF(pos, 0));
+        painter.drawLine(QPointF(pos, graphRectScaled.height()-4), QPointF(pos, graphRectScaled.height()));
 
-        Xpos += step;
+        const TickLabel &label = tickLabels.getLabel(ZeGraphView::tickLabelValue(tick, axesTicks.x.offset), 'g', numPrec, painter.font());
+        space = label.width;
+        tickLabels.draw(painter, label, QPointF(pos - space/2, graphRectScaled.height()+15));
     }
 
 //trace sur l'axe des Y
 
-    double Ypos = ceil(graphView.Ymin / graphSettings.gridSettings.yGridStep) * graphSettings.gridSettings.yGridStep * uniteY;
-    step = graphSettings.gridSettings.yGridStep * uniteY;
-    end = graphView.Ymax * uniteY;
-
     int largestWidth = 0;
 
-    while(Ypos <= end)
+    for(const ZeAxisTick &tick : axesTicks.y.ticks)
     {
-        if(fabs(Ypos) > 1)
+        pos = centre.y - tick.pos * uniteY;
+
+        if(pos < 0 || pos > graphRectScaled.height())
+            continue;
+
+        if(grid.alongY.showGrid && fabs(pos - centre.y) > 1)
         {
-            if(graphSettings.gridSettings.gridType == ZeGridType::GRID)
-            {
-                pen.setColor(graphSettings.gridColor);
-                pen.setWidthF(0.5);
-                painter.setPen(pen);
-                painter.drawLine(QPointF(0, -Ypos + centre.y), QPointF(graphRectScaled.width(), -Ypos + centre.y));
-            }
-
-            pen.setColor(graphSettings.axesColor);
-            pen.setWidth(1);
+            pen.setColor(grid.alongY.gridColor);
+            pen.setWidthF(grid.alongY.gridLineWidth);
             painter.setPen(pen);
+            painter.drawLine(QPointF(0, pos), QPointF(graphRectScaled.width(), pos));
+        }
 
-            pos = -Ypos + centre.y;
+        pen.setColor(viewSettings.axes.y.color);
+        pen.setWidth(1);
+        painter.setPen(pen);
 
-            painter.drawLine(QPointF(4, pos), QPointF(0, pos));
-            painter.drawLine(QPointF(graphRectScaled.width() - 4, pos), QPointF(graphRectScaled.width(), pos));
+        painter.drawLine(QPointF(4, pos), QPointF(0, pos));
+        painter.drawLine(QPointF(graphRectScaled.width() - 4, pos), QPointF(graphRectScaled.width(), pos));
 
-            num = QString::number(Ypos/uniteY, 'g', numPrec);
-            space = fontMetrics.width(num) + 5;
+        const TickLabel &label = tickLabels.getLabel(ZeGraphView::tickLabelValue(tick, axesTicks.y.offset), 'g', numPrec, painter.font());
+        space = label.width + 5;
 
-            if(space > largestWidth)
-                largestWidth = space;
+        if(space > largestWidth)
+            largestWidth = int(space);
 
-            painter.drawText(QPointF(-space, pos + graphSettings.graphFont.pixelSize()/2), num);
-        }
-        else
-        {
-            pos = -Ypos + centre.y;
-            space = fontMetrics.width("0") + 5;
-            painter.drawText(QPointF(-space, pos + graphSettings.graphFont.pixelSize()/2), "0");
-        }
+        tickLabels.draw(painter, label, QPointF(-space, pos + viewSettings.graph.graphFont.pixelSize()/2));
+    }
 
-        if(space > largestWidth)
-            largestWidth = space;
+    // far from zero, the labels are relative to an offset written once in the corner of the axis
+
+    double xOffset = ZeGraphView::offsetValue(axesTicks.x), yOffset = ZeGraphView::offsetValue(axesTicks.y);
+
+    pen.setColor(viewSettings.axes.x.color);
+    painter.setPen(pen);
 
-        Ypos += step;
+    if(xOffset != 0)
+    {
+        QString offsetStr = (xOffset > 0 ? "+" : "") + QString::number(xOffset, 'g', numPrec);
+        painter.drawText(QPointF(graphRectScaled.width() - painter.fontMetrics().width(offsetStr) - 6, graphRectScaled.height() - 8), offsetStr);
+    }
+
+    pen.setColor(viewSettings.axes.y.color);
+    painter.setPen(pen);
+
+    if(yOffset != 0)
+    {
+        QString offsetStr = (yOffset > 0 ? "+" : "") + QString::number(yOffset, 'g', numPrec);
+        painter.drawText(QPointF(6, painter.fontMetrics().ascent() + 6), offsetStr);
     }
 
     if(leftMargin - additionalMargin - largestWidth > 8 || leftMargin - additionalMargin - largestWidth < 4)
@@ -340,8 +328,6 @@ void ImagePreview::drawTicksAndNumbers()
         leftMargin = largestWidth + additionalMargin + 6;
         update();
     }
-
-
 }
 
 void ImagePreview::drawAxes()
@@ -381,6 +367,8 @@ void ImagePreview::updateCenterPosAndScaling()
     }
     centre.x = - graphView->viewRect().left() * uniteX;
     centre.y =  graphView->viewRect().top() * uniteY;
+
+    graphView->setViewPxSize(graphRectScaled.size());
 }
 
 QImage* ImagePreview::drawImage()
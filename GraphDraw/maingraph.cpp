@@ -21,9 +21,9 @@
 #include "GraphDraw/maingraph.h"
 
 
-MainGraph::MainGraph(Information *info) : GraphDraw(info)
+MainGraph::MainGraph(Information *info) : GraphDraw(info), frameScheduler(this)
 {
-    graphRange = info->getGraphRange();
+    graphView.setGraphRange(info->getViewSettings().range);
     tickIntervals = info->getGraphTickIntervals();    
     
     setMinimumSize(QSize(200, 200));
@@ -33,8 +33,14 @@ MainGraph::MainGraph(Information *info) : GraphDraw(info)
     connect(info, SIGNAL(newGraphSettings()), this, SLOT(updateGraph()));
     connect(info, SIGNAL(dataUpdated()), this, SLOT(updateData()));
     connect(info, SIGNAL(animationUpdate()), this, SLOT(updateParEq()));
-    connect(info, SIGNAL(gridStateChange()), this, SLOT(updateGraph()));
-    connect(info, SIGNAL(drawStateUpdateOccured()), this, SLOT(reactivateSmoothing()));
+    connect(info, SIGNAL(gridStateChange()), this, SLOT(updateGridLayer()));
+    connect(info, SIGNAL(funcsDrawStateChanged()), this, SLOT(updateFuncsLayer()));
+    connect(info, SIGNAL(seqsDrawStateChanged()), this, SLOT(updateSeqsLayer()));
+    connect(info, SIGNAL(linesDrawStateChanged()), this, SLOT(updateLinesLayer()));
+    connect(info, SIGNAL(parEqsDrawStateChanged()), this, SLOT(updateParEqLayer()));
+    connect(funcValuesSaver, SIGNAL(curvesRefined()), this, SLOT(updateFuncCurves()));
+    connect(&frameScheduler, SIGNAL(framesDropped(int)), this, SIGNAL(framesDropped(int)));
+    connect(funcValuesSaver, SIGNAL(curvesDropped(int)), this, SIGNAL(curvesDropped(int)));
 
     exprCalculator = new ExprCalculator(false, info->getFuncsList());
 
@@ -104,6 +110,14 @@ MainGraph::MainGraph(Information *info) : GraphDraw(info)
 
     savedGraph = nullptr;
 
+    for(int layer = 0 ; layer < LAYERS_NUM ; layer++)
+    {
+        layers << QImage();
+        dirtyLayers << true;
+    }
+    recomposeLayers = true;
+    panning = resaveAfterPan = false;
+
     setMouseTracking(true);
     cursorType = NORMAL;
 
@@ -114,13 +128,13 @@ void MainGraph::reactivateSmoothing()
 {
     moving = recalculate = false;
     resaveGraph = true;
-    update();
+    scheduleFrame();
 }
 
 void MainGraph::updateParEq()
 {
     animationUpdate = true;
-    repaint();
+    scheduleFrame();
 }
 
 void MainGraph::updateGraph()
@@ -129,18 +143,64 @@ void MainGraph::updateGraph()
     {
         resaveGraph = true;
         recalculate = true;
-        update();
+        scheduleFrame();
     }
     cancelUpdateSignal = false;
 
 }
 
+void MainGraph::updateFuncCurves()
+{
+    invalidateLayer(FUNCTIONS_LAYER);
+    scheduleFrame();
+}
+
 void MainGraph::updateData()
 {
-    resaveGraph = true;
+    invalidateLayer(DATA_LAYER);
+    invalidateLayer(REGRESSIONS_LAYER);
     recalculate = false;
     recalculateRegs = true;
-    update();
+    scheduleFrame();
+}
+
+void MainGraph::updateGridLayer()
+{
+    invalidateLayer(GRID_LAYER);
+    scheduleFrame();
+}
+
+void MainGraph::updateFuncsLayer()
+{
+    moving = false;
+    invalidateLayer(FUNCTIONS_LAYER);
+    scheduleFrame();
+}
+
+void MainGraph::updateSeqsLayer()
+{
+    moving = false;
+    invalidateLayer(SEQUENCES_LAYER);
+    scheduleFrame();
+}
+
+void MainGraph::updateLinesLayer()
+{
+    moving = false;
+    invalidateLayer(LINES_LAYER);
+    scheduleFrame();
+}
+
+void MainGraph::updateParEqLayer()
+{
+    moving = false;
+    invalidateLayer(PAR_EQ_LAYER);
+    scheduleFrame();
+}
+
+void MainGraph::invalidateLayer(int layer)
+{
+    dirtyLayers[layer] = true;
 }
 
 void MainGraph::addOtherWidgets()
@@ -349,36 +409,20 @@ void MainGraph::wheelEvent(QWheelEvent *event)
     x = (x-centre.x)/uniteX;
     y = -(y-centre.y)/uniteY;
 
-<<<<<<< HEAD
-    double valeur = tanh(double(event->angleDelta().y()) / 1024) / 1.1;
-
-    if((graphRange.Xmax - graphRange.Xmin > MIN_RANGE && graphRange.Ymax - graphRange.Ymin > MIN_RANGE) || valeur < 0)
-    {
-        graphRange.Xmax -= (graphRange.Xmax - x)*valeur;
-        graphRange.Xmin -= (graphRange.Xmin - x)*valeur;
-        graphRange.Ymax -= (graphRange.Ymax - y)*valeur;
-        graphRange.Ymin -= (graphRange.Ymin - y)*valeur;
-
-        moving = true;
-        recalculate = true;
+    double ratio = tanh((double)(event->angleDelta().y()) / 1024) / 1.1;
 
-        if(graphSettings.smoothing)
-            repaintTimer.start();
+    graphView.zoomView(QPointF(x,y), ratio);
 
-        emit graphRangeChanged(graphRange);
+    moving = true;
+    recalculate = true;
 
-        update();
-    }
-=======
-    double ratio = tanh((double)(event->angleDelta().y()) / 1024) / 1.1;
+    if(graphSettings.smoothing)
+        repaintTimer.start();
 
-    graphView.zoomView(QPointF(x,y), ratio);
-    information->setRange(graphView);
->>>>>>> master
+    publishGraphRange();
+    scheduleFrame();
 
     event->accept();
-
-    //the graph will update from the "information" class updateoccured() signal
 }
 
 void MainGraph::afficherPtX(double x)
@@ -412,7 +456,7 @@ void MainGraph::afficherPtX(double x)
             }
         }
 
-        update();
+        scheduleFrame();
 
     }
 }
@@ -465,17 +509,31 @@ void MainGraph::newWindowSize()
     }
 }
 
+void MainGraph::scheduleFrame()
+{
+    frameScheduler.requestFrame();
+}
+
+void MainGraph::publishGraphRange()
+{
+    GraphRange range = information->getViewSettings().range;
+
+    range.x.min = graphView.getXmin();
+    range.x.max = graphView.getXmax();
+    range.y.min = graphView.getYmin();
+    range.y.max = graphView.getYmax();
+
+    information->setGraphRange(range);
+}
+
 void MainGraph::paintEvent(QPaintEvent *event)
 {
+    frameScheduler.beginFrame();
+
     graphWidthPx = width();
     graphHeightPx = height();
 
-<<<<<<< HEAD
-    graphSettings = information->getSettingsVals();  
-=======
     graphSettings = information->getGraphSettings();
-    graphView = information->getGraphView();
->>>>>>> master
 
     if(windowSize != size())
     {
@@ -484,12 +542,26 @@ void MainGraph::paintEvent(QPaintEvent *event)
        recalculate = true;
     }
 
-    if(!moving && (cursorType == NORMAL || hWidgetHideTransition.isActive() || vWidgetHideTransition.isActive() ||
+    if(!moving && resaveAfterPan)
+    {
+        // the strips exposed while panning were drawn without smoothing
+        resaveAfterPan = false;
+        resaveGraph = true;
+    }
+
+    if(moving && panning)
+    {
+        scrollLayers();
+        indirectPaint();
+    }
+    else if(!moving && (cursorType == NORMAL || hWidgetHideTransition.isActive() || vWidgetHideTransition.isActive() ||
             hWidgetShowTransition.isActive() || vWidgetShowTransition.isActive() || hWidgetState || vWidgetState ||
                    animationUpdate))
         indirectPaint();
     else directPaint();
 
+    frameScheduler.endFrame();
+
     event->accept();
 }
 
@@ -498,8 +570,8 @@ void MainGraph::indirectPaint()
 
     if(resaveTangent)
         addTangentToBuffer();
-    if(resaveGraph)
-        resaveImageBuffer();
+
+    resaveImageBuffer();
 
     painter.begin(this);
 
@@ -510,7 +582,6 @@ void MainGraph::indirectPaint()
     painter.scale(1/uniteX, -1/uniteY);
 
     drawAnimatedParEq();
-    drawData();
     animationUpdate = false;
 
     if(dispPoint)
@@ -536,25 +607,9 @@ void MainGraph::directPaint()
     painter.setFont(information->getGraphSettings().graphFont);
 
     painter.setBrush(QBrush(graphSettings.backgroundColor));
-<<<<<<< HEAD
     painter.drawRect(-1, -1, graphWidthPx+1, graphHeightPx+1);
 
     updateCenterPosAndScaling();
-    drawAxes();
-    drawTicksAndNumbers();
-
-    if(updateTickSpacing())
-    {
-        cancelUpdateSignal = true;
-        emit graphTickIntervalsChanged(tickIntervals);
-
-        painter.setBrush(QBrush(graphSettings.backgroundColor));
-        painter.drawRect(-1, -1, graphWidthPx+1, graphHeightPx+1);
-=======
-    painter.drawRect(-1, -1, graphWidth+1, graphHeight+1);
-
-    updateCenterPosAndScaling();
->>>>>>> master
 
     painter.translate(QPointF(centre.x, centre.y));
     painter.scale(1/uniteX, -1/uniteY);
@@ -574,8 +629,9 @@ void MainGraph::directPaint()
     if(recalculate)
     {
         recalculate = false;
-        funcValuesSaver->calculateAll(uniteX, uniteY, graphView);
+        funcValuesSaver->calculateProgressively(uniteX, uniteY, graphView);
         recalculateRegVals();
+        recalculateParEqs();
     }
     else if(recalculateRegs)
     {
@@ -610,6 +666,44 @@ void MainGraph::drawHoveringConsequence()
     {
         drawOneSequence(mouseState.id, graphSettings.curvesThickness + 4);
     }
+    else if(mouseState.pointedObjectType == REGRESSION || mouseState.pointedObjectType == PAR_EQ || mouseState.pointedObjectType == DATA)
+    {
+        GeometryKind kind = GeometryKind::Regression;
+        QColor color;
+
+        if(mouseState.pointedObjectType == REGRESSION)
+            color = information->getRegression(mouseState.id)->getColor();
+        else if(mouseState.pointedObjectType == PAR_EQ)
+        {
+            kind = GeometryKind::ParEq;
+            color = parEqs->at(mouseState.id)->getColorSaver()->getColor(mouseState.kPos);
+        }
+        else
+        {
+            kind = GeometryKind::Data;
+            color = information->getDataStyle(mouseState.id).color;
+        }
+
+        bool points = false;
+        QList<QPolygonF> geometry = geometryIndex.getGeometry(kind, GeometryRef{mouseState.id, mouseState.kPos}, points);
+
+        pen.setWidth(graphSettings.curvesThickness + (points ? 4 : 1));
+        pen.setColor(color);
+
+        painter.save();
+        painter.resetTransform();
+        painter.setPen(pen);
+        painter.setRenderHint(QPainter::Antialiasing);
+
+        for(const QPolygonF &polyline : geometry)
+        {
+            if(points)
+                painter.drawPoints(polyline);
+            else painter.drawPolyline(polyline);
+        }
+
+        painter.restore();
+    }
     else if(mouseState.pointedObjectType == TANGENT_MOVE || mouseState.pointedObjectType == TANGENT_RESIZE)
     {
         TangentWidget *tangent = tangents->at(mouseState.id);
@@ -640,77 +734,238 @@ void MainGraph::addTangentToBuffer()
 {
     resaveTangent = false;
 
-    painter.begin(savedGraph);
-
-    painter.translate(QPointF(centre.x, centre.y));
-    painter.setRenderHint(QPainter::Antialiasing);
-    drawOneTangent(tangentDrawException);
     tangentDrawException = -1;
+    invalidateLayer(LINES_LAYER);
 
     cancelUpdateSignal = true;
     information->emitUpdateSignal();
-
-    painter.end();
 }
 
 void MainGraph::resaveImageBuffer()
 {
-    resaveGraph = false;
+    // each layer is cached in its own image and only the invalidated ones are drawn again,
+    // the hovering and selection overlays are drawn over their composition at every frame
 
-    checkIfActiveSelectionConflicts();
+    bool viewChanged = false; // the cached images no longer match the view transform
 
-    delete savedGraph;
-    savedGraph = new QImage(size(), QImage::Format_RGB32);
+    if(resaveGraph)
+    {
+        resaveGraph = false;
+        viewChanged = true;
 
-    painter.begin(savedGraph);
-    //trace du background
+        for(int layer = 0 ; layer < LAYERS_NUM ; layer++)
+            dirtyLayers[layer] = true;
+    }
 
-    painter.setFont(information->getGraphSettings().graphFont);
+    if(!dirtyLayers.contains(true) && !recomposeLayers && savedGraph != nullptr && savedGraph->size() == size())
+        return;
 
-    painter.setBrush(QBrush(graphSettings.backgroundColor));
-<<<<<<< HEAD
-    painter.drawRect(-1, -1, graphWidthPx+1, graphHeightPx+1);
-=======
-    painter.drawRect(-1, -1, graphWidth+1, graphHeight+1);
->>>>>>> master
+    checkIfActiveSelectionConflicts();
 
     updateCenterPosAndScaling();
-    drawAxes();
-    drawGridAndCoordinates();
 
     if(recalculate)
     {
         recalculate = false;
-        funcValuesSaver->calculateAll(uniteX, uniteY, graphView);
+        funcValuesSaver->calculateProgressively(uniteX, uniteY, graphView);
         recalculateRegVals();
+        recalculateParEqs();
+
+        viewChanged = true;
+
+        for(int layer = 0 ; layer < LAYERS_NUM ; layer++)
+            dirtyLayers[layer] = true;
     }
     else if(recalculateRegs)
     {
         recalculateRegs = false;
         recalculateRegVals();
+        dirtyLayers[REGRESSIONS_LAYER] = true;
     }
 
-    painter.translate(QPointF(centre.x, centre.y));
+    // past the frame budget, the sequences, parametric equations, regressions and data keep
+    // their previous image and are drawn in the next frame, unless the view moved under them
 
-    drawFunctions();
-    drawSequences();
-    drawStraightLines();
-    drawTangents();
-    drawStaticParEq();
-    drawRegressions();
+    bool deferred = false;
+
+    for(int layer = 0 ; layer < LAYERS_NUM ; layer++)
+    {
+        if(!dirtyLayers[layer] && layers[layer].size() == size())
+            continue;
+
+        bool urgent = layer == GRID_LAYER || layer == FUNCTIONS_LAYER || layer == LINES_LAYER;
+
+        if(!urgent && !viewChanged && layers[layer].size() == size() && frameScheduler.isOverBudget())
+            deferred = true;
+        else renderLayer(layer);
+    }
+
+    if(deferred)
+        scheduleFrame();
+
+    if(recomposeLayers || savedGraph == nullptr || savedGraph->size() != size())
+        composeLayers();
+}
+
+void MainGraph::renderLayer(int layer, const QRect &area)
+{
+    // a null area draws the whole layer, otherwise only that part of it is cleared and drawn
+
+    recomposeLayers = true;
+
+    if(area.isNull())
+    {
+        dirtyLayers[layer] = false;
+
+        if(geometryIndex.getSize() != size())
+            geometryIndex.reset(size());
+
+        indexGeometry = true;
+
+        if(layer == FUNCTIONS_LAYER)
+            geometryIndex.clear(GeometryKind::Function);
+        else if(layer == SEQUENCES_LAYER)
+            geometryIndex.clear(GeometryKind::Sequence);
+        else if(layer == PAR_EQ_LAYER)
+            geometryIndex.clear(GeometryKind::ParEq);
+        else if(layer == REGRESSIONS_LAYER)
+            geometryIndex.clear(GeometryKind::Regression);
+        else if(layer == DATA_LAYER)
+            geometryIndex.clear(GeometryKind::Data);
+        else indexGeometry = false;
+
+        if(layers[layer].size() != size())
+            layers[layer] = QImage(size(), layer == GRID_LAYER ? QImage::Format_RGB32 : QImage::Format_ARGB32_Premultiplied);
+
+        if(layer == GRID_LAYER)
+            layers[layer].fill(graphSettings.backgroundColor);
+        else layers[layer].fill(Qt::transparent);
+    }
+
+    painter.begin(&layers[layer]);
+    painter.setFont(information->getGraphSettings().graphFont);
+
+    if(!area.isNull())
+    {
+        painter.setClipRect(area);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(area, Qt::transparent);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+        clipViewRect = QRectF(QPointF((area.left() - centre.x) / uniteX, (centre.y - area.bottom() - 1) / uniteY),
+                              QPointF((area.right() + 1 - centre.x) / uniteX, (centre.y - area.top()) / uniteY));
+    }
+
+    if(layer == GRID_LAYER)
+    {
+        drawAxes();
+        drawGridAndCoordinates();
+    }
+    else
+    {
+        painter.translate(QPointF(centre.x, centre.y));
+
+        if(layer == FUNCTIONS_LAYER)
+            drawFunctions();
+        else if(layer == SEQUENCES_LAYER)
+            drawSequences();
+        else if(layer == LINES_LAYER)
+        {
+            drawStraightLines();
+            drawTangents();
+        }
+        else if(layer == PAR_EQ_LAYER)
+        {
+            // the animation trails may use colors or points that just changed
+            trails.clear();
+            drawStaticParEq();
+        }
+        else if(layer == REGRESSIONS_LAYER)
+            drawRegressions();
+        else if(layer == DATA_LAYER)
+        {
+            painter.scale(1/uniteX, -1/uniteY);
+            drawData();
+        }
+    }
+
+    painter.end();
+
+    clipViewRect = QRectF();
+    indexGeometry = false;
+}
+
+void MainGraph::scrollLayers()
+{
+    // while panning, the cached layers are shifted by the mouse delta and only the exposed strips are drawn,
+    // using the curve ends FuncValuesSaver::move() computed. The grid layer is drawn again entirely since
+    // its tick labels stick to the graph's borders. The straight lines and tangents are still drawn whole,
+    // they are a few primitives the strip's clip discards
+
+    QPoint shift = panShift;
+    panShift = QPoint();
+
+    if(shift.isNull() || resaveGraph || recalculate || savedGraph == nullptr || savedGraph->size() != size())
+        return;
+
+    resaveAfterPan = true;
+
+    updateCenterPosAndScaling();
+
+    QRegion exposed = QRegion(rect()) - QRegion(rect().translated(shift));
+
+    // the exposed strips are not indexed, hovering them works again once the layers are drawn entirely
+    geometryIndex.translate(shift);
+
+    for(int layer = FUNCTIONS_LAYER ; layer < LAYERS_NUM ; layer++)
+    {
+        if(dirtyLayers[layer] || layers[layer].size() != size())
+            continue;
+
+        if(scrollBuffer.size() != size() || scrollBuffer.format() != layers[layer].format())
+            scrollBuffer = QImage(size(), layers[layer].format());
+
+        scrollBuffer.fill(Qt::transparent);
+
+        painter.begin(&scrollBuffer);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(shift, layers[layer]);
+        painter.end();
+
+        layers[layer].swap(scrollBuffer);
+
+        for(const QRect &strip : exposed.rects())
+            renderLayer(layer, strip);
+    }
+
+    dirtyLayers[GRID_LAYER] = true;
+    recomposeLayers = true;
+}
+
+void MainGraph::composeLayers()
+{
+    recomposeLayers = false;
+
+    if(savedGraph == nullptr || savedGraph->size() != size())
+    {
+        delete savedGraph;
+        savedGraph = new QImage(size(), QImage::Format_RGB32);
+    }
+
+    painter.begin(savedGraph);
+
+    for(int layer = 0 ; layer < LAYERS_NUM ; layer++)
+        painter.drawImage(QPoint(0,0), layers[layer]);
 
     painter.end();
 }
 
 void MainGraph::updateCenterPosAndScaling()
 {
-<<<<<<< HEAD
-    uniteY = graphHeightPx / (graphRange.Ymax - graphRange.Ymin);
-    uniteX = graphWidthPx / (graphRange.Xmax - graphRange.Xmin);
-=======
-    uniteY = graphHeight / (graphView.viewRect().height());
-    uniteX = graphWidth / (graphView.viewRect().width());
->>>>>>> master
+    uniteY = graphHeightPx / (graphView.viewRect().height());
+    uniteX = graphWidthPx / (graphView.viewRect().width());
+
+    graphView.setViewPxSize(size());
 
     Point pt;
     pt.x = uniteX;
@@ -726,21 +981,12 @@ void MainGraph::updateCenterPosAndScaling()
         uniteY = uniteX;
 
         cancelUpdateSignal = true;
-<<<<<<< HEAD
-        emit graphRangeChanged(graphRange);
-        recalculate = true;
-    }
-
-    centre.x = - graphRange.Xmin * uniteX;
-    centre.y =  graphRange.Ymax * uniteY;
-=======
-        information->setRange(graphView);
+        publishGraphRange();
         recalculate = true;
     }
 
     centre.x = - graphView.viewRect().left() * uniteX;
     centre.y =  graphView.viewRect().top() * uniteY;
->>>>>>> master
 
 }
 
@@ -775,6 +1021,63 @@ void MainGraph::drawAllParEq()
     drawStaticParEq();
 }
 
+void MainGraph::updateParEqTrail(ParEqWidget *parWidget, int listEnd)
+{
+    // the tracks of a t animated equation are kept in an image of their own, each frame only adds
+    // the segments between the previous position and the current one. The image is drawn again from
+    // the start when the points, the view or the animation's direction change
+
+    AnimationTrail &trail = trails[parWidget];
+    QList< QList<Point> > *list = parWidget->getPointsList();
+    ColorSaver *colorSaver = parWidget->getColorSaver();
+
+    if(trail.image.size() != size() || trail.revision != parWidget->getPointsRevision() || trail.transform != painter.transform() ||
+            listEnd < trail.drawnPos)
+    {
+        if(trail.image.size() != size())
+            trail.image = QImage(size(), QImage::Format_ARGB32_Premultiplied);
+
+        trail.image.fill(Qt::transparent);
+        trail.revision = parWidget->getPointsRevision();
+        trail.transform = painter.transform();
+        trail.drawnPos = 0;
+    }
+
+    if(listEnd > trail.drawnPos)
+    {
+        QPainter trailPainter(&trail.image);
+        trailPainter.setTransform(trail.transform);
+        trailPainter.setRenderHint(QPainter::Antialiasing, graphSettings.smoothing && !moving);
+
+        QPen trailPen = pen;
+        QPolygonF polygon;
+        Point point;
+
+        for(int curve = 0; curve < list->size(); curve++)
+        {
+            trailPen.setColor(colorSaver->getColor(curve));
+            trailPainter.setPen(trailPen);
+
+            polygon.clear();
+
+            for(int pos = qMax(0, trail.drawnPos - 1) ; pos < listEnd && pos < list->at(curve).size(); pos++)
+            {
+                point = list->at(curve).at(pos);
+                polygon << QPointF(point.x * uniteX, - point.y * uniteY);
+            }
+
+            trailPainter.drawPolyline(polygon);
+        }
+
+        trail.drawnPos = listEnd;
+    }
+
+    painter.save();
+    painter.resetTransform();
+    painter.drawImage(QPoint(0, 0), trail.image);
+    painter.restore();
+}
+
 void MainGraph::drawAnimatedParEq()
 {
     painter.setRenderHint(QPainter::Antialiasing, graphSettings.smoothing && !moving);
@@ -789,54 +1092,71 @@ void MainGraph::drawAnimatedParEq()
     painter.setPen(pen);
 
     int listEnd;
+    QSet<ParEqWidget*> trailed;
 
     for(int i = 0; i < parEqs->size(); i++)
     {
         parWidget = parEqs->at(i);
         colorSaver = parWidget->getColorSaver();
 
-        if(parWidget->isAnimated() && parWidget->getDrawState())
+        if(!parWidget->isAnimated() || !parWidget->getDrawState())
+            continue;
+
+        if(parWidget->is_t_Animated())
         {
-            if(parWidget->is_t_Animated())
-                list = parWidget->getPointsList();
-            else list = parWidget->getCurrentPolygon();
+            // the tracks come from the trail image, only the moving points are drawn at every frame
+
+            list = parWidget->getPointsList();
+            listEnd = parWidget->getCurrentTPos();
+
+            if(parWidget->keepTracks())
+            {
+                updateParEqTrail(parWidget, listEnd);
+                trailed << parWidget;
+            }
+
+            pen.setWidth(graphSettings.curvesThickness + 4);
 
             for(int curve = 0; curve < list->size(); curve++)
             {
-                if(!parWidget->is_t_Animated())// equals is_k_animated
-                    pen.setColor(colorSaver->getColor(parWidget->getCurrentKPos()));
-                else pen.setColor(colorSaver->getColor(curve));
+                if(listEnd < 1 || listEnd > list->at(curve).size())
+                    continue;
 
+                pen.setColor(colorSaver->getColor(curve));
                 painter.setPen(pen);
 
-                polygon.clear();
+                point = list->at(curve).at(listEnd - 1);
+                painter.drawPoint(QPointF(point.x * uniteX, - point.y * uniteY));
+            }
+
+            pen.setWidth(graphSettings.curvesThickness);
+            painter.setPen(pen);
+        }
+        else // equals is_k_animated
+        {
+            list = parWidget->getCurrentPolygon();
 
-                if(parWidget->is_t_Animated())
-                    listEnd = parWidget->getCurrentTPos();
-                else listEnd = list->at(curve).size();
+            pen.setColor(colorSaver->getColor(parWidget->getCurrentKPos()));
+            painter.setPen(pen);
 
-                for(int pos = 0 ; pos < listEnd; pos ++)
+            for(int curve = 0; curve < list->size(); curve++)
+            {
+                polygon.clear();
+
+                for(int pos = 0 ; pos < list->at(curve).size(); pos ++)
                 {
                     point = list->at(curve).at(pos);
                     polygon << QPointF(point.x * uniteX, - point.y * uniteY);
                 }
 
-                if(parWidget->keepTracks() || !parWidget->is_t_Animated())
-                    painter.drawPolyline(polygon);
-
-                if(parWidget->is_t_Animated())
-                {
-                    pen.setWidth(graphSettings.curvesThickness + 4);
-                    painter.setPen(pen);
-
-                    painter.drawPoint(polygon.last());
-
-                    pen.setWidth(graphSettings.curvesThickness);
-                    painter.setPen(pen);
-                }
+                painter.drawPolyline(polygon);
             }
         }
     }
+
+    for(ParEqWidget *widget : trails.keys())
+        if(!trailed.contains(widget))
+            trails.remove(widget);
 }
 
 void MainGraph::drawPoint()
@@ -912,7 +1232,7 @@ void MainGraph::mousePressEvent(QMouseEvent *event)
             selectedCurve.id = mouseState.id;
             selectedCurve.selectedObject = mouseState.pointedObjectType;
             tangentDrawException = mouseState.id;
-            resaveGraph = true;
+            invalidateLayer(LINES_LAYER);
         }
     }
     else if(event->buttons() & Qt::RightButton)
@@ -927,10 +1247,16 @@ void MainGraph::mouseReleaseEvent(QMouseEvent *event)
 {
     Q_UNUSED(event);
     ongoingMouseClick = false;
+    panning = false;
 
     if(cursorType == NORMAL)
     {
-        if(mouseState.pointedObjectType  != SelectableMathObject::NONE && !mouseState.tangentHovering)
+        // regressions, parametric equations and data are highlighted when hovered but cannot be selected
+
+        bool selectable = mouseState.pointedObjectType == FUNCTION || mouseState.pointedObjectType == SEQUENCE ||
+                          mouseState.pointedObjectType == TANGENT_MOVE || mouseState.pointedObjectType == TANGENT_RESIZE;
+
+        if(selectable && !mouseState.tangentHovering)
         {
             selectedCurve.tangentSelection = mouseState.tangentHovering;
             selectedCurve.isSomethingSelected = true;
@@ -945,7 +1271,7 @@ void MainGraph::mouseReleaseEvent(QMouseEvent *event)
             {
                 selectedCurve.isSomethingSelected = false;
                 tangentDrawException = selectedCurve.id;
-                resaveGraph = true;
+                invalidateLayer(LINES_LAYER);
             }
             else if(!xyWidgetsState)
                 xyWidgetsShowTransition.start();
@@ -964,7 +1290,10 @@ void MainGraph::mouseReleaseEvent(QMouseEvent *event)
             }
             else moving = false;
 
-            update();
+            if(funcValuesSaver->isRefinementPending())
+                recalculate = resaveGraph = true;
+
+            scheduleFrame();
         }
     }
     else if(cursorType == ZOOMBOX)
@@ -980,13 +1309,12 @@ void MainGraph::mouseReleaseEvent(QMouseEvent *event)
             viewRect.setTop((- rectReel.top() + centre.y) / uniteY);
             viewRect.setBottom((- rectReel.bottom() + centre.y) / uniteY);
 
-<<<<<<< HEAD
-            if(win.Xmax - win.Xmin > MIN_RANGE && win.Ymax - win.Ymin > MIN_RANGE)
-                emit graphRangeChanged(graphRange);
-=======
             if(viewRect.width() > MIN_RANGE && viewRect.height() > MIN_RANGE)
+            {
                 graphView.setViewRect(viewRect);
->>>>>>> master
+                publishGraphRange();
+                recalculate = true;
+            }
 
             cursorType = NORMAL;
         }
@@ -1040,16 +1368,17 @@ void MainGraph::mouseMoveEvent(QMouseEvent *event)
         mouseTangentHoverTest(x, y);
 
         if(mouseState.pointedObjectType == SelectableMathObject::NONE)
-        {
-            mouseSeqHoverTest(x, y);
-            refresh = refresh || mouseState.pointedObjectType  != SelectableMathObject::NONE;
-        }
-
+            mouseObjectHoverTest(GeometryKind::Sequence, SEQUENCE, graphSettings.curvesThickness + 3);
         if(mouseState.pointedObjectType == SelectableMathObject::NONE)
-        {
-            mouseFuncHoverTest(x, y);
-            refresh = refresh || mouseState.pointedObjectType  != SelectableMathObject::NONE;
-        }
+            mouseObjectHoverTest(GeometryKind::Function, FUNCTION, graphSettings.curvesThickness + 1);
+        if(mouseState.pointedObjectType == SelectableMathObject::NONE)
+            mouseObjectHoverTest(GeometryKind::Regression, REGRESSION, graphSettings.curvesThickness + 1);
+        if(mouseState.pointedObjectType == SelectableMathObject::NONE)
+            mouseObjectHoverTest(GeometryKind::ParEq, PAR_EQ, graphSettings.curvesThickness + 1);
+        if(mouseState.pointedObjectType == SelectableMathObject::NONE)
+            mouseObjectHoverTest(GeometryKind::Data, DATA, graphSettings.curvesThickness + 3);
+
+        refresh = refresh || mouseState.pointedObjectType  != SelectableMathObject::NONE;
 
         if(mouseState.pointedObjectType == SelectableMathObject::NONE && mouseState.id != -1)
         {
@@ -1064,13 +1393,11 @@ void MainGraph::mouseMoveEvent(QMouseEvent *event)
 
             graphView.translateView(QPointF(dx, dy));
 
-            cancelUpdateSignal = true;
-<<<<<<< HEAD
+            panShift += QPoint(qRound(mouseX - lastPosSouris.x), qRound(mouseY - lastPosSouris.y));
+            panning = true;
 
-            emit graphRangeChanged(graphRange);
-=======
-            information->setRange(graphView);
->>>>>>> master
+            cancelUpdateSignal = true;
+            publishGraphRange();
 
             updateCenterPosAndScaling();
 
@@ -1095,7 +1422,7 @@ void MainGraph::mouseMoveEvent(QMouseEvent *event)
     lastPosSouris.y = event->y();
 
     if(refresh)
-        update();
+        scheduleFrame();
 
 
 
@@ -1109,8 +1436,6 @@ void MainGraph::moveSavedRegsValues()
 
 void MainGraph::mouseMoveWithActiveSelection(double x, double y)
 {
-    Q_UNUSED(y);
-
     int k_pos = 0;
     double k = 0;
 
@@ -1133,28 +1458,33 @@ void MainGraph::mouseMoveWithActiveSelection(double x, double y)
     }
     else if(selectedCurve.selectedObject == SEQUENCE && x >= seqs[0]->get_nMin()-0.3)
     {
-        double start, step = 1;
-        bool ok = true;
-
-        if(graphView.viewRect().left() > seqs[0]->get_nMin())
-            start = trunc(graphView.viewRect().left());
-        else start = seqs[0]->get_nMin();
-
-        if(uniteX < 1)
-            step = 5*trunc(1/uniteX);
-
-        if(fabs(trunc((x-start)/step) - (x-start)/step) < 0.5*step)
-            pointUnit.x = trunc((x-start)/step) * step + start;
-        else pointUnit.x = trunc((x-start)/step) * step + start + step;
+        // snaps to the nearest drawn point, the lowest or the highest term of a pixel column
 
-        pointUnit.y = seqs[selectedCurve.id]->getSeqValue(pointUnit.x, ok, k_pos);
+        const QList<QPolygonF> &points = getSequencePoints(selectedCurve.id);
 
-        if(!ok)
+        if(k_pos >= points.size() || points[k_pos].isEmpty())
         {
             selectedCurve.isSomethingSelected = false;
             return;
         }
 
+        QPointF mouse(graphView.unitToViewX(x), graphView.unitToViewY(y)), nearest = points[k_pos].first();
+        double dist, nearestDist = std::numeric_limits<double>::max();
+
+        for(const QPointF &point : points[k_pos])
+        {
+            dist = pow((point.x() - mouse.x()) * uniteX, 2) + pow((point.y() - mouse.y()) * uniteY, 2);
+
+            if(dist < nearestDist)
+            {
+                nearest = point;
+                nearestDist = dist;
+            }
+        }
+
+        pointUnit.x = round(graphView.viewToUnitX(nearest.x()));
+        pointUnit.y = graphView.viewToUnitY(nearest.y());
+
         dispPoint = true;
         recalculate = false;
     }
@@ -1169,120 +1499,29 @@ void MainGraph::mouseMoveWithActiveSelection(double x, double y)
     }
 }
 
-void MainGraph::mouseFuncHoverTest(double x, double y)
+void MainGraph::mouseObjectHoverTest(GeometryKind kind, int type, double radius)
 {
-    double calcY = 0;
-    double k = 0;
-    int draw;
-    double rangeLimit;
-    Range kRange;
-
-    for(short i = 0; i < funcs.size(); i++)
-    {
-        if(!funcs[i]->getDrawState())
-            continue;
+    // the pointed object is looked up in the geometry indexed when its layer was drawn, nothing is evaluated
 
-        kRange = funcs[i]->getParametricRange();
-        k = kRange.start;
-        draw = 0;
-        rangeLimit = kRange.start + kRange.step * PAR_DRAW_LIMIT;
-
-        while(k <= kRange.end && k < rangeLimit )
-        {
-            calcY = funcs[i]->getFuncValue(x, k);
-
-            if(!(std::isnan(calcY) || std::isinf(calcY)))
-            {
-                if(!(selectedCurve.isSomethingSelected && selectedCurve.selectedObject == FUNCTION && draw == selectedCurve.kPos && i == selectedCurve.id))
-                {
-                    if((fabs(calcY - y) * uniteY) < graphSettings.curvesThickness + 1)
-                    {
-                        mouseState.tangentHovering = false;
-                        mouseState.pointedObjectType = FUNCTION;
-                        mouseState.isParametric = funcs[i]->isFuncParametric();
-                        mouseState.kPos = draw;
-                        mouseState.id = i;
-                        recalculate = false;
-
-                        return;
-                    }
-                }
-            }
-            k += kRange.step;
-            draw++;
-        }
-    }
-}
-
-void MainGraph::mouseSeqHoverTest(double x, double y)
-{
-    double calcY = 0;
-    int drawsNum = 1;
-    bool ok;
-    double nMin = seqs[0]->get_nMin();
-
-    if(x > nMin)
-    {
-        double intAbscissa = 0;
-        double start, step = 1;
-
-        if(graphView.viewRect().left() > nMin)
-            start = trunc(graphView.viewRect().left());
-        else start = nMin;
-
-        if(uniteX < 1)
-             step = 5*trunc(1/uniteX);
-
-<<<<<<< HEAD
-        if(fabs((trunc((x-start)/step) - (x-start)/step) * uniteX) < double(graphSettings.curvesThickness) + 2)
-=======
-        if(fabs((trunc((x-start)/step) - (x-start)/step) * uniteX) < (double)(graphSettings.curvesThickness) + 2)
->>>>>>> master
-            intAbscissa = trunc((x-start)/step) * step + start;
-
-        if(std::isnan(intAbscissa))
-            return;
-
-        for(short i = 0; i < 6; i++)
-        {
-            if(!seqs[i]->isSeqValid())
-                continue;
-
-            drawsNum = seqs[i]->getDrawsNum();
-            ok = true;
-
-            for(short draw = 0 ; draw < drawsNum ; draw++)
-            {
-                calcY = seqs[i]->getSeqValue(intAbscissa, ok, draw);
-
-                if(!ok)
-                    break;
-
-                if(!(selectedCurve.isSomethingSelected && selectedCurve.selectedObject == SEQUENCE && draw == selectedCurve.kPos && i == selectedCurve.id))
-                {
-                    if((fabs(calcY - y) * uniteY) < graphSettings.curvesThickness + 3)
-<<<<<<< HEAD
-                    {                        
-=======
-                    {
-                        mouseState.hovering = true;
->>>>>>> master
-                        mouseState.tangentHovering = false;
-                        mouseState.pointedObjectType = SEQUENCE;
-                        mouseState.isParametric = seqs[i]->isSeqParametric();
-                        mouseState.kPos = draw;
-                        mouseState.id = i;
-                        recalculate = false;
-                        return;
-                    }
-                }
-            }
-        }
-    }
+    GeometryRef excluded{-1, -1}, ref;
 
+    if(selectedCurve.isSomethingSelected && selectedCurve.selectedObject == type)
+        excluded = GeometryRef{selectedCurve.id, selectedCurve.kPos};
 
+    if(!geometryIndex.nearest(kind, QPointF(mouseX, mouseY), radius, ref, excluded))
+        return;
 
+    mouseState.tangentHovering = false;
+    mouseState.pointedObjectType = SelectableMathObject(type);
+    mouseState.isParametric = false;
+    mouseState.kPos = ref.kPos;
+    mouseState.id = ref.id;
+    recalculate = false;
 
+    if(type == FUNCTION)
+        mouseState.isParametric = funcs[ref.id]->isFuncParametric();
+    else if(type == SEQUENCE)
+        mouseState.isParametric = seqs[ref.id]->isSeqParametric();
 }
 
 void MainGraph::mouseTangentHoverTest(double x, double y)
@@ -1330,23 +1569,28 @@ void MainGraph::mouseTangentHoverTest(double x, double y)
     }
 
     if(found)
-        update();
+        scheduleFrame();
 }
 
 void MainGraph::drawGridAndCoordinates()
 {
-    pen.setColor(graphSettings.axesColor);
+    // the ticks come from the view's tick engine, which only shifts them while the view is translated
+
+    ZeAxesTicks axesTicks = graphView.getAxesTicks();
+    const ZeGridSettings &grid = viewSettings.grid;
+
+    pen.setColor(viewSettings.axes.x.color);
     pen.setWidth(1);
     painter.setPen(pen);
     painter.setRenderHint(QPainter::Antialiasing, false);
 
-    double start, end, Ypos, posTxt;
+    double start, end, Xpos, Ypos, posTxt;
 
     //trace sur l'axe des X
     if(centre.y < 20)
     {
         Ypos = 20;
-        posTxt = Ypos + graphSettings.graphFont.pixelSize() + 3;
+        posTxt = Ypos + viewSettings.graph.graphFont.pixelSize() + 3;
     }
     else if(graphHeightPx - centre.y < 20)
     {
@@ -1356,68 +1600,71 @@ void MainGraph::drawGridAndCoordinates()
     else
     {
         Ypos = centre.y;
-        posTxt = Ypos + graphSettings.graphFont.pixelSize() + 3;
+        posTxt = Ypos + viewSettings.graph.graphFont.pixelSize() + 3;
     }
 
-<<<<<<< HEAD
-    double Xreal = trunc(graphRange.Xmin / tickIntervals.x) * tickIntervals.x;
-    double Xpos = Xreal * uniteX + centre.x;
-    double pos;
+    widestXNumber = 0;
 
-    double step = tickIntervals.x * uniteX;
-=======
-    double Xreal = trunc(graphView.viewRect().left() / gridSettings.xGridStep) * gridSettings.xGridStep;
-    double Xpos = Xreal * uniteX + centre.x;
-    double pos;
+    for(const ZeAxisTick &tick : axesTicks.x.ticks)
+        widestXNumber = qMax(widestXNumber, tickLabels.getLabel(ZeGraphView::tickLabelValue(tick, axesTicks.x.offset), 'g', NUM_PREC, painter.font()).width);
 
-    double step = gridSettings.xGridStep * uniteX;
->>>>>>> master
+    start = 5;
+    end = graphWidthPx - 5;
 
-    double bas = height();
-    double haut = 0;
+    // far from zero, the labels are relative to an offset written once at the end of the axis
 
-    QString num = QString::number(Xreal, 'g', NUM_PREC);
-    widestXNumber = painter.fontMetrics().width(num);
+    double offset = ZeGraphView::offsetValue(axesTicks.x);
 
-    start = 5;
-    end = graphWidthPx - 5;
+    if(offset != 0)
+    {
+        QString offsetStr = (offset > 0 ? "+" : "") + QString::number(offset, 'g', NUM_PREC);
+        double offsetWidth = painter.fontMetrics().width(offsetStr);
+
+        painter.drawText(QPointF(graphWidthPx - 5 - offsetWidth, posTxt), offsetStr);
+        end -= offsetWidth + 10;
+    }
 
     if(centre.x < 10)
-        start = 10 + painter.fontMetrics().width(num)/2 + 5;
+        start = 10 + widestXNumber/2 + 5;
     else if(centre.x > graphWidthPx - 10)
-        end = graphWidthPx - 10 - painter.fontMetrics().width(num)/2 - 5;
+        end = graphWidthPx - 10 - widestXNumber/2 - 5;
 
-    while(Xpos <= end)
+    if(grid.alongX.showSubGrid)
     {
-        if(start <= Xpos && fabs(Xpos - centre.x) > 1)
+        pen.setColor(grid.alongX.subgridColor);
+        pen.setWidthF(grid.alongX.subgridLineWidth);
+        painter.setPen(pen);
+
+        for(const ZeAxisSubTick &subTick : axesTicks.x.axisSubticks)
         {
-            if(start <= Xpos && graphSettings.gridSettings.gridType == ZeGridType::GRID && Xpos <= end)
-            {
-                pen.setColor(graphSettings.gridColor);
-                pen.setWidthF(0.5);
-                painter.setPen(pen);
-                painter.drawLine(QPointF(Xpos, bas), QPointF(Xpos, haut));
+            Xpos = centre.x + subTick.pos * uniteX;
+            painter.drawLine(QPointF(Xpos, 0), QPointF(Xpos, graphHeightPx));
+        }
+    }
 
-                pen.setColor(graphSettings.axesColor);
-                pen.setWidth(1);
-                painter.setPen(pen);
-            }
+    for(const ZeAxisTick &tick : axesTicks.x.ticks)
+    {
+        Xpos = centre.x + tick.pos * uniteX;
 
-            painter.drawLine(QPointF(Xpos, Ypos -3), QPointF(Xpos, Ypos));
-            num = QString::number(Xreal, 'g', NUM_PREC);
-            pos = Xpos - painter.fontMetrics().width(num)/2;
-            painter.drawText(QPointF(pos, posTxt), num);
+        if(Xpos < start || Xpos > end || fabs(Xpos - centre.x) <= 1)
+            continue;
 
-            if(painter.fontMetrics().width(num) > widestXNumber)
-                widestXNumber = painter.fontMetrics().width(num);
+        if(grid.alongX.showGrid)
+        {
+            pen.setColor(grid.alongX.gridColor);
+            pen.setWidthF(grid.alongX.gridLineWidth);
+            painter.setPen(pen);
+            painter.drawLine(QPointF(Xpos, 0), QPointF(Xpos, graphHeightPx));
         }
 
-        Xpos += step;
-<<<<<<< HEAD
-        Xreal += tickIntervals.x;
-=======
-        Xreal += gridSettings.xGridStep;
->>>>>>> master
+        pen.setColor(viewSettings.axes.x.color);
+        pen.setWidth(1);
+        painter.setPen(pen);
+
+        painter.drawLine(QPointF(Xpos, Ypos -3), QPointF(Xpos, Ypos));
+
+        const TickLabel &label = tickLabels.getLabel(ZeGraphView::tickLabelValue(tick, axesTicks.x.offset), 'g', NUM_PREC, painter.font());
+        tickLabels.draw(painter, label, QPointF(Xpos - label.width/2, posTxt));
     }
 
 //trace sur l'axe des Y
@@ -1441,141 +1688,90 @@ void MainGraph::drawGridAndCoordinates()
         posTxt = Xpos + 5;
     }
 
-<<<<<<< HEAD
-    double Yreal = trunc(graphRange.Ymax / tickIntervals.y) * tickIntervals.y;
-    Ypos = -Yreal * uniteY + centre.y;
-    step = tickIntervals.y * uniteY;
-=======
-    double Yreal = trunc(graphView.viewRect().top() / graphSettings.gridSettings.yGridStep) * graphSettings.gridSettings.yGridStep;
-    Ypos = -Yreal * uniteY + centre.y;
-    step = graphSettings.gridSettings.yGridStep * uniteY;
->>>>>>> master
-
-    bas =  0;
-    haut =  graphWidthPx;
-
     start = 5;
     end = graphHeightPx - 5;
 
-
     if(graphHeightPx - centre.y < 10)
         end = graphHeightPx - 50;
     else if(centre.y < 10)
         start = 50;
 
-
     double txtCorr = + painter.fontMetrics().ascent()/2 - 2;
 
-    while(Ypos <= end)
-    {
-        if(start <= Ypos && fabs(Ypos - centre.y) > 1)
-        {
-            if(information->getGridSettings().gridType == ZeGridType::GRID)
-            {
-                pen.setColor(graphSettings.gridColor);
-                pen.setWidthF(0.5);
-                painter.setPen(pen);
-                painter.drawLine(QPointF(bas, Ypos), QPointF(haut, Ypos));
+    offset = ZeGraphView::offsetValue(axesTicks.y);
 
-                pen.setColor(graphSettings.axesColor);
-                pen.setWidth(1);
-                painter.setPen(pen);
-            }
-
-            painter.drawLine(QPointF(Xpos  -3, Ypos), QPointF(Xpos, Ypos));
-            num = QString::number(Yreal, 'g', NUM_PREC);
-            if(drawOnRight)
-                painter.drawText(QPointF(posTxt - painter.fontMetrics().width(num), Ypos + txtCorr), num);
-            else painter.drawText(QPointF(posTxt, Ypos + txtCorr), num);
-        }
+    if(offset != 0)
+    {
+        QString offsetStr = (offset > 0 ? "+" : "") + QString::number(offset, 'g', NUM_PREC);
+        double offsetPos = drawOnRight ? posTxt - painter.fontMetrics().width(offsetStr) : posTxt;
 
-<<<<<<< HEAD
-        Yreal -= tickIntervals.y;
-=======
-        Yreal -= graphSettings.gridSettings.yGridStep;
->>>>>>> master
-        Ypos += step;
+        pen.setColor(viewSettings.axes.y.color);
+        painter.setPen(pen);
+        painter.drawText(QPointF(offsetPos, start + painter.fontMetrics().ascent()), offsetStr);
+        start += painter.fontMetrics().height() + 10;
     }
-}
-
-<<<<<<< HEAD
-bool MainGraph::updateTickSpacing()
-{
-    bool tickSpacingChanged = false;
-    bool orthonormal = information->isOrthonormal();
 
-    if(uniteX * tickIntervals.x < widestXNumber + 32)
-    {
-        while(uniteX * tickIntervals.x < widestXNumber + 32)
-            tickIntervals.x *= 2;
-        if(orthonormal)
-             tickIntervals.y = tickIntervals.x;
-        tickSpacingChanged = true;
-    }
-    else if(uniteX * tickIntervals.x > 2*widestXNumber + 96)
+    if(grid.alongY.showSubGrid)
     {
-        while(uniteX * tickIntervals.x > 2*widestXNumber + 96)
-            tickIntervals.x /= 2;
-        if(orthonormal)
-             tickIntervals.y = tickIntervals.x;
-        tickSpacingChanged = true;
-    }
-    if(!orthonormal)
-    {
-        if(uniteY * tickIntervals.y < 25)
+        pen.setColor(grid.alongY.subgridColor);
+        pen.setWidthF(grid.alongY.subgridLineWidth);
+        painter.setPen(pen);
+
+        for(const ZeAxisSubTick &subTick : axesTicks.y.axisSubticks)
         {
-            while(uniteY * tickIntervals.y < 25)
-                tickIntervals.y *= 2;
-            tickSpacingChanged = true;
+            Ypos = centre.y - subTick.pos * uniteY;
+            painter.drawLine(QPointF(0, Ypos), QPointF(graphWidthPx, Ypos));
         }
-        else if(uniteY * tickIntervals.y > 150)
+    }
+
+    for(const ZeAxisTick &tick : axesTicks.y.ticks)
+    {
+        Ypos = centre.y - tick.pos * uniteY;
+
+        if(Ypos < start || Ypos > end || fabs(Ypos - centre.y) <= 1)
+            continue;
+
+        if(grid.alongY.showGrid)
         {
-            while(uniteY * tickIntervals.y > 150)
-                tickIntervals.y /= 2;
-            tickSpacingChanged = true;
+            pen.setColor(grid.alongY.gridColor);
+            pen.setWidthF(grid.alongY.gridLineWidth);
+            painter.setPen(pen);
+            painter.drawLine(QPointF(0, Ypos), QPointF(graphWidthPx, Ypos));
         }
-    }
 
-    return tickSpacingChanged;
+        pen.setColor(viewSettings.axes.y.color);
+        pen.setWidth(1);
+        painter.setPen(pen);
+
+        painter.drawLine(QPointF(Xpos  -3, Ypos), QPointF(Xpos, Ypos));
+
+        const TickLabel &label = tickLabels.getLabel(ZeGraphView::tickLabelValue(tick, axesTicks.y.offset), 'g', NUM_PREC, painter.font());
+        if(drawOnRight)
+            tickLabels.draw(painter, label, QPointF(posTxt - label.width, Ypos + txtCorr));
+        else tickLabels.draw(painter, label, QPointF(posTxt, Ypos + txtCorr));
+    }
 }
 
-=======
->>>>>>> master
 void MainGraph::drawAxes()
 {
     // *********** remarque: les y sont positifs en dessous de l'axe x, step au dessus !! ************//
     pen.setWidth(1);
     pen.setColor(graphSettings.axesColor);
-<<<<<<< HEAD
     painter.setPen(pen);
-=======
-    painter.setPen(pen);    
->>>>>>> master
     painter.setRenderHint(QPainter::Antialiasing, false);
 
     axesIntersec.y = centre.y;
     axesIntersec.x = centre.x;
 
-<<<<<<< HEAD
-    if(graphRange.Ymin > -20/uniteY)
-        axesIntersec.y = graphHeightPx - 20;
-    else if(graphRange.Ymax < 20/uniteY)
-=======
     if(graphView.viewRect().bottom() > -20/uniteY)
-        axesIntersec.y = graphHeight - 20;
+        axesIntersec.y = graphHeightPx - 20;
     else if(graphView.viewRect().top() < 20/uniteY)
->>>>>>> master
         axesIntersec.y = 20;
 
     if(graphView.viewRect().left() > -10/uniteX)
         axesIntersec.x = 10;
-<<<<<<< HEAD
-    else if(graphRange.Xmax < 10/uniteX)
-        axesIntersec.x = graphWidthPx - 10;
-=======
     else if(graphView.viewRect().right() < 10/uniteX)
-        axesIntersec.x = graphWidth - 10;
->>>>>>> master
+        axesIntersec.x = graphWidthPx - 10;
 
 
     //ordinates axis
@@ -1609,35 +1805,18 @@ void MainGraph::drawAxes()
 
 void MainGraph::zoomX()
 {
-    double valeur = (graphRange.Xmax- graphRange.Xmin) * double(hSlider->value()) * 0.0016;
-
-<<<<<<< HEAD
-    if((graphRange.Xmax - graphRange.Xmin > MIN_RANGE && graphRange.Ymax - graphRange.Ymin > MIN_RANGE) || valeur < 0)
-    {
-        repaintTimer.stop();
-
-        graphRange.Xmin += valeur;
-        graphRange.Xmax -= valeur;
-
-        moving = true;
-
-        emit graphRangeChanged(graphRange);
-
-        if(graphSettings.smoothing)
-            repaintTimer.start();
+    repaintTimer.stop();
 
-        update();
-    }
-=======
     double ratio = (graphView.viewRect().right()- graphView.viewRect().left()) * (double)(hSlider->value()) * 0.0016;
 
     graphView.zoomXview(ratio);
     moving = true;
-    information->setRange(graphView);
+    publishGraphRange();
 
     if(graphSettings.smoothing)
         repaintTimer.start();
->>>>>>> master
+
+    scheduleFrame();
 }
 
 void MainGraph::stop_X_zoom()
@@ -1648,38 +1827,12 @@ void MainGraph::stop_X_zoom()
 
 void MainGraph::zoomY()
 {
-    double valeur = (graphRange.Ymax - graphRange.Ymin) * double(vSlider->value()) * 0.0016;
-
-<<<<<<< HEAD
-    if((graphRange.Xmax - graphRange.Xmin > MIN_RANGE && graphRange.Ymax - graphRange.Ymin > MIN_RANGE) || valeur < 0)
-    {
-        repaintTimer.stop();
-
-        if(!information->isOrthonormal())
-        {
-            graphRange.Ymin += valeur;
-            graphRange.Ymax -= valeur;
-            recalculate = false;
-        }
-        else
-        {
-            graphRange.Xmin += valeur;
-            graphRange.Xmax -= valeur;
-            recalculate = true;
-        }
-
-        moving = true;
-        if(graphSettings.smoothing)
-            repaintTimer.start();
+    repaintTimer.stop();
 
-        emit graphRangeChanged(graphRange);
-        update();
-    }
-=======
     double valeur = (graphView.viewRect().top() - graphView.viewRect().bottom()) * (double)(vSlider->value()) * 0.0016;
 
     if(!information->isOrthonormal())
-    {        
+    {
         graphView.zoomYview(valeur);
         recalculate = false;
     }
@@ -1693,8 +1846,8 @@ void MainGraph::zoomY()
     if(graphSettings.smoothing)
         repaintTimer.start();
 
-    information->setRange(graphView);
->>>>>>> master
+    publishGraphRange();
+    scheduleFrame();
 }
 
 void MainGraph::stop_Y_Zoom()
@@ -1705,17 +1858,17 @@ void MainGraph::stop_Y_Zoom()
 
 void MainGraph::setGraphRange(GraphRange range)
 {
-    graphRange = range;
+    graphView.setGraphRange(range);
     recalculate = true;
     resaveGraph = true;
-    update();
+    scheduleFrame();
 }
 
 void MainGraph::setGraphTickIntervals(GraphTickIntervals interval)
 {
     tickIntervals = interval;
     resaveGraph = true;
-    update();
+    scheduleFrame();
 }
 
 MainGraph::~MainGraph()
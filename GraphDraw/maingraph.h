@@ -25,6 +25,7 @@
 #define MainGraph_H
 
 #include "graphdraw.h"
+#include "GraphDraw/framescheduler.h"
 
 
 class MainGraph : public GraphDraw
@@ -42,6 +43,8 @@ signals:
 
     void graphRangeChanged(GraphRange range);
     void graphTickIntervalsChanged(GraphTickIntervals interval);
+    void framesDropped(int total);
+    void curvesDropped(int total);
 
 public slots:
     void setGraphRange(GraphRange range);
@@ -58,6 +61,12 @@ public slots:
     void updateParEq();
     void updateGraph();
     void updateData();
+    void updateFuncCurves();
+    void updateGridLayer();
+    void updateFuncsLayer();
+    void updateSeqsLayer();
+    void updateLinesLayer();
+    void updateParEqLayer();
 
 protected slots:
 
@@ -72,6 +81,8 @@ protected slots:
 protected:
 
     void paintEvent(QPaintEvent *event);    
+    void scheduleFrame();
+    void publishGraphRange();
     void mousePressEvent(QMouseEvent *event);
     void mouseMoveEvent(QMouseEvent *event);
     void mouseReleaseEvent(QMouseEvent *event);
@@ -79,10 +90,13 @@ protected:
     void addOtherWidgets();
 
     void mouseMoveWithActiveSelection(double x, double y);
-    void mouseFuncHoverTest(double x, double y);
-    void mouseSeqHoverTest(double x, double y);
     void mouseTangentHoverTest(double x, double y);
-    void resaveImageBuffer();    
+    void mouseObjectHoverTest(GeometryKind kind, int type, double radius);
+    void resaveImageBuffer();
+    void renderLayer(int layer, const QRect &area = QRect());
+    void composeLayers();
+    void scrollLayers();
+    void invalidateLayer(int layer);
     void addTangentToBuffer();
     void drawHoveringConsequence();  
 
@@ -92,6 +106,7 @@ protected:
 
     void drawAxes();
     void drawAnimatedParEq();  
+    void updateParEqTrail(ParEqWidget *parWidget, int listEnd);
     void drawAllParEq();
 
     void updateCenterPosAndScaling();
@@ -103,7 +118,8 @@ protected:
     void checkIfActiveSelectionConflicts();
 
     enum CursorType {NORMAL, DEZOOMER, ZOOMBOX, DEPLACER, NO_CURSOR};
-    enum SelectableMathObject {NONE, FUNCTION, SEQUENCE, TANGENT_RESIZE, TANGENT_MOVE};
+    enum RenderLayer {GRID_LAYER, FUNCTIONS_LAYER, SEQUENCES_LAYER, LINES_LAYER, PAR_EQ_LAYER, REGRESSIONS_LAYER, DATA_LAYER, LAYERS_NUM};
+    enum SelectableMathObject {NONE, FUNCTION, SEQUENCE, TANGENT_RESIZE, TANGENT_MOVE, REGRESSION, PAR_EQ, DATA};
 
     struct MouseState
     {
@@ -143,7 +159,21 @@ protected:
     MouseState mouseState;
 
     QRect rectReel, hWidgetRect, vWidgetRect;
-    QImage *savedGraph;
+    QImage *savedGraph; // composition of the layers below
+    QList<QImage> layers;
+    QList<bool> dirtyLayers;
+    bool recomposeLayers, panning, resaveAfterPan;
+    QImage scrollBuffer;
+    QPoint panShift;
+
+    struct AnimationTrail
+    {
+        QImage image;
+        QTransform transform;
+        int revision = -1, drawnPos = 0; // the points of the curves before drawnPos are in the image
+    };
+    QHash<ParEqWidget*, AnimationTrail> trails;
+    FrameScheduler frameScheduler;
     QList <QString> customFunctions;
     QList <QString> customSequences;
 
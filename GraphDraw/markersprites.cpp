@@ -0,0 +1,92 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#include "GraphDraw/markersprites.h"
+
+MarkerSprites::MarkerSprites()
+{
+    coef = sqrt(3)/2;
+}
+
+const QPixmap& MarkerSprites::getSprite(PointStyle style, int width, const QColor &color, bool antialiasing)
+{
+    QString key = QString("%1/%2/%3/%4").arg(int(style)).arg(width).arg(color.rgba()).arg(antialiasing);
+
+    auto sprite = sprites.find(key);
+
+    if(sprite == sprites.end())
+    {
+        if(sprites.size() >= MAX_MARKER_SPRITES)
+            sprites.clear();
+
+        sprite = sprites.insert(key, renderSprite(style, width, color, antialiasing));
+    }
+
+    return *sprite;
+}
+
+QPixmap MarkerSprites::renderSprite(PointStyle style, double w, const QColor &color, bool antialiasing)
+{
+    // the markers are drawn around the center of a square pixmap large enough for the cross and the triangle
+
+    int side = 2 * int(ceil(2.5 * w)) + 4;
+    QPointF pt(side / 2.0, side / 2.0);
+
+    QPixmap pixmap(side, side);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    QPen pen(color);
+    painter.setPen(pen);
+    painter.setBrush(QBrush(color));
+    painter.setRenderHint(QPainter::Antialiasing, antialiasing);
+
+    QPolygonF polygon;
+
+    switch(style)
+    {
+    case PointStyle::Rhombus:
+        polygon << pt + QPointF(-w,0) << pt + QPointF(0,w) << pt + QPointF(w,0) << pt + QPointF(0,-w);
+        painter.drawPolygon(polygon);
+        break;
+    case PointStyle::Disc:
+        painter.drawEllipse(pt, w, w);
+        break;
+    case PointStyle::Square:
+        painter.setRenderHint(QPainter::Antialiasing, false);
+        painter.drawRect(QRectF(pt + QPointF(-w,-w), pt + QPointF(w,w)));
+        break;
+    case PointStyle::Triangle:
+        polygon << pt + QPointF(0, -2*w) << pt + QPointF(2*w*coef, w) << pt + QPointF(-2*w*coef, w);
+        painter.drawPolygon(polygon);
+        break;
+    case PointStyle::Cross:
+        painter.setRenderHint(QPainter::Antialiasing, false);
+        pen.setWidthF(w);
+        painter.setPen(pen);
+        painter.drawLine(pt + QPointF(0, 2*w), pt + QPointF(0, -2*w));
+        painter.drawLine(pt + QPointF(-2*w, 0), pt + QPointF(2*w, 0));
+        break;
+    }
+
+    return pixmap;
+}
@@ -0,0 +1,47 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#ifndef MARKERSPRITES_H
+#define MARKERSPRITES_H
+
+#include "structures.h"
+
+#define MAX_MARKER_SPRITES 64 // the cache is emptied when it grows beyond this count
+
+class MarkerSprites
+{
+    // Data point markers rendered once per style, size, color and smoothing,
+    // so that drawing a data set is a batch of pixmap stamps
+
+public:
+    MarkerSprites();
+
+    const QPixmap& getSprite(PointStyle style, int width, const QColor &color, bool antialiasing);
+
+protected:
+    QPixmap renderSprite(PointStyle style, double w, const QColor &color, bool antialiasing);
+
+    QHash<QString, QPixmap> sprites;
+    double coef;
+};
+
+#endif // MARKERSPRITES_H
@@ -0,0 +1,73 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#include "GraphDraw/ticklabelcache.h"
+
+TickLabelCache::TickLabelCache()
+{
+    usesCounter = 0;
+}
+
+const TickLabel& TickLabelCache::getLabel(double value, char format, int precision, const QFont &font)
+{
+    TickLabelKey key{value, format, precision, font};
+    usesCounter++;
+
+    auto cached = labels.find(key);
+
+    if(cached != labels.end())
+    {
+        cached->lastUse = usesCounter;
+        return *cached;
+    }
+
+    if(labels.size() >= TICK_LABELS_CACHE_SIZE)
+    {
+        auto oldest = labels.begin();
+
+        for(auto label = labels.begin() ; label != labels.end() ; label++)
+            if(label->lastUse < oldest->lastUse)
+                oldest = label;
+
+        labels.erase(oldest);
+    }
+
+    QFontMetricsF metrics(font);
+
+    TickLabel label;
+    label.text.setText(QString::number(value, format, precision));
+    label.text.setTextFormat(Qt::PlainText);
+    label.text.setPerformanceHint(QStaticText::AggressiveCaching);
+    label.text.prepare(QTransform(), font);
+    label.width = metrics.width(label.text.text());
+    label.ascent = metrics.ascent();
+    label.lastUse = usesCounter;
+
+    return *labels.insert(key, label);
+}
+
+void TickLabelCache::draw(QPainter &painter, const TickLabel &label, QPointF baseline)
+{
+    // static texts are positioned from their top left corner, while drawText() takes the baseline
+
+    painter.drawStaticText(baseline - QPointF(0, label.ascent), label.text);
+}
@@ -0,0 +1,71 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#ifndef TICKLABELCACHE_H
+#define TICKLABELCACHE_H
+
+#include <QtWidgets>
+
+#define TICK_LABELS_CACHE_SIZE 256
+
+struct TickLabelKey
+{
+    double value;
+    char format;
+    int precision;
+    QFont font;
+
+    bool operator==(const TickLabelKey &other) const
+    {
+        return value == other.value && format == other.format && precision == other.precision && font == other.font;
+    }
+};
+
+inline uint qHash(const TickLabelKey &key, uint seed = 0)
+{
+    return qHash(key.value, seed) ^ qHash(int(key.format) << 8 | key.precision, seed) ^ qHash(key.font, seed);
+}
+
+struct TickLabel
+{
+    QStaticText text;
+    double width, ascent;
+    quint64 lastUse;
+};
+
+class TickLabelCache
+{
+    // Tick labels are laid out once and drawn as static text in the next frames, the least recently
+    // used ones are evicted past TICK_LABELS_CACHE_SIZE labels
+
+public:
+    TickLabelCache();
+
+    const TickLabel& getLabel(double value, char format, int precision, const QFont &font);
+    void draw(QPainter &painter, const TickLabel &label, QPointF baseline);
+
+protected:
+    QHash<TickLabelKey, TickLabel> labels;
+    quint64 usesCounter;
+};
+
+#endif // TICKLABELCACHE_H
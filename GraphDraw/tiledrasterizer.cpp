@@ -0,0 +1,126 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#include "GraphDraw/tiledrasterizer.h"
+
+TiledRasterizer::TiledRasterizer(QPainter *targetPainter)
+{
+    painter = targetPainter;
+    transform = painter->transform();
+    antialiasing = painter->testRenderHint(QPainter::Antialiasing);
+    pointsNum = 0;
+
+    // only the part of the device left visible by the painter's clip gets tiles
+
+    QRect area(0, 0, painter->device()->width(), painter->device()->height());
+
+    if(painter->hasClipping())
+        area &= painter->transform().mapRect(painter->clipBoundingRect()).toAlignedRect();
+
+    for(int y = area.top() ; y <= area.bottom() ; y += RASTER_TILE_SIZE)
+    {
+        for(int x = area.left() ; x <= area.right() ; x += RASTER_TILE_SIZE)
+        {
+            tiles << (QRect(x, y, RASTER_TILE_SIZE, RASTER_TILE_SIZE) & area);
+            tileStrokes << QList<int>();
+        }
+    }
+}
+
+void TiledRasterizer::addPolyline(const QPolygonF &polyline, const QPen &pen)
+{
+    if(polyline.isEmpty())
+        return;
+
+    RasterStroke stroke;
+    stroke.polyline = polyline;
+    stroke.pen = pen;
+
+    double margin = pen.widthF() + 2;
+    QRectF bounds = transform.map(polyline).boundingRect().adjusted(-margin, -margin, margin, margin);
+
+    for(int tile = 0 ; tile < tiles.size() ; tile++)
+    {
+        if(bounds.intersects(tiles[tile]))
+            tileStrokes[tile] << strokes.size();
+    }
+
+    strokes << stroke;
+    pointsNum += polyline.size();
+}
+
+void TiledRasterizer::renderTile(int tile)
+{
+    QImage &image = tileImages[tile];
+
+    image = QImage(tiles[tile].size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter tilePainter(&image);
+    tilePainter.setRenderHint(QPainter::Antialiasing, antialiasing);
+
+    // tiles are offset by whole pixels, so the coverage of a stroke is the same on both sides of a tile border
+    tilePainter.setTransform(transform * QTransform::fromTranslate(-tiles[tile].x(), -tiles[tile].y()));
+
+    for(int stroke : tileStrokes[tile])
+    {
+        tilePainter.setPen(strokes[stroke].pen);
+        tilePainter.drawPolyline(strokes[stroke].polyline);
+    }
+}
+
+void TiledRasterizer::render()
+{
+    if(pointsNum < RASTER_PARALLEL_MIN_POINTS || QThreadPool::globalInstance()->maxThreadCount() < 2)
+    {
+        for(const RasterStroke &stroke : strokes)
+        {
+            painter->setPen(stroke.pen);
+            painter->drawPolyline(stroke.polyline);
+        }
+        return;
+    }
+
+    tileImages.resize(tiles.size());
+
+    QList< QFuture<void> > futures;
+
+    for(int tile = 0 ; tile < tiles.size() ; tile++)
+    {
+        if(!tileStrokes[tile].isEmpty())
+            futures << QtConcurrent::run([this, tile]() { renderTile(tile); });
+    }
+
+    for(QFuture<void> &future : futures)
+        future.waitForFinished();
+
+    painter->save();
+    painter->resetTransform();
+
+    for(int tile = 0 ; tile < tiles.size() ; tile++)
+    {
+        if(!tileStrokes[tile].isEmpty())
+            painter->drawImage(tiles[tile].topLeft(), tileImages[tile]);
+    }
+
+    painter->restore();
+}
@@ -0,0 +1,64 @@
+/****************************************************************************
+**  Copyright (c) 2019, Adel Kara Slimane <adel.ks@zegrapher.com>
+**
+**  This file is part of ZeGrapher's source code.
+**
+**  ZeGrapher is free software: you may copy, redistribute and/or modify it
+**  under the terms of the GNU General Public License as published by the
+**  Free Software Foundation, either version 3 of the License, or (at your
+**  option) any later version.
+**
+**  This file is distributed in the hope that it will be useful, but
+**  WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+**  General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#ifndef TILEDRASTERIZER_H
+#define TILEDRASTERIZER_H
+
+#include <QtWidgets>
+#include <QtConcurrent>
+
+#define RASTER_TILE_SIZE 256 // in pixels
+#define RASTER_PARALLEL_MIN_POINTS 20000 // below this many points, polylines are drawn directly on the calling thread
+
+struct RasterStroke
+{
+    QPolygonF polyline;
+    QPen pen;
+};
+
+class TiledRasterizer
+{
+    // Collects the polylines a QPainter would draw on an image, then splits the image into tiles
+    // that are rasterized by worker threads in their own QImage, and composited with the painter.
+    // Each tile draws every stroke crossing it in insertion order, so overlaps stay the same.
+
+public:
+    TiledRasterizer(QPainter *targetPainter);
+
+    void addPolyline(const QPolygonF &polyline, const QPen &pen);
+    void render();
+
+protected:
+    void renderTile(int tile);
+
+    QPainter *painter;
+    QTransform transform;
+    bool antialiasing;
+    int pointsNum;
+
+    QList<RasterStroke> strokes;
+    QList<QRect> tiles;
+    QList< QList<int> > tileStrokes;
+    QVector<QImage> tileImages;
+};
+
+#endif // TILEDRASTERIZER_H
@@ -36,6 +36,10 @@ ParEqWidget::ParEqWidget(int num, QList<FuncCalculator*> list, QColor col) : tre
     increment = 1;
     current_pos = 1;
     current_t = current_k = 0;
+    pointsRevision = 0;
+    sampling.xUnit = sampling.yUnit = 1;
+    pendingCurvesNum = 0;
+    polygonResetPending = false;
 
     QColor color;
     color.setNamedColor(VALID_COLOR);
@@ -439,16 +443,11 @@ void ParEqWidget::apply()
 
     if(hasSomethingChanged && valid)
     {
+        frameCache.clear();
         calculatePointsList();
 
         currentPolygon.clear();
-
-        if(tWidget->isAnimateChecked())
-            for(short i = 0 ; i < pointsList.size(); i++)
-                currentPolygon << pointsList[i].mid(0, 1);
-
-        else if(kWidget->isAnimateChecked())
-            currentPolygon << pointsList[0];
+        polygonResetPending = true;
 
         current_tPos = 0;
         current_kPos = 0;
@@ -468,6 +467,9 @@ void ParEqWidget::checkXline()
 {
     if(xExpr != xLine->text())
     {
+        frameCache.cancel();
+        cancelPointsComputation();
+
         if(xTree != nullptr)
             treeCreator.deleteFastTree(xTree);
 
@@ -486,6 +488,9 @@ void ParEqWidget::checkYline()
 {
     if(yExpr != yLine->text())
     {
+        frameCache.cancel();
+        cancelPointsComputation();
+
         if(yTree != nullptr)
             treeCreator.deleteFastTree(yTree);
 
@@ -506,18 +511,23 @@ void ParEqWidget::updateTRange(double k)
         hasSomethingChanged = true;
 
     tRange = tWidget->getRange(k);
-    tPos_end = trunc((tRange.end - tRange.start)/(tRange.step * ratio)) + 1;
+    // tiny steps over wide ranges give point counts past the int range, they are counted in double
 
-    int pointsNum = trunc((tRange.end - tRange.start)/tRange.step) + 1;
+    tPos_end = int(qMin(trunc((tRange.end - tRange.start)/(tRange.step * ratio)) + 1, double(std::numeric_limits<int>::max())));
 
-    isTRangeGood = tWidget->isValid() && 20000 > pointsNum && pointsNum > 0;
+    double pointsNum = trunc((tRange.end - tRange.start)/tRange.step) + 1;
+
+    // adaptively sampled curves don't compute every t step, only uniformly sampled ones are limited
+    bool adaptive = !sampling.view.isNull() && !isAnimated();
+
+    isTRangeGood = tWidget->isValid() && (adaptive || 20000 > pointsNum) && pointsNum > 0;
     if(!isTRangeGood)
         valid = false;
 
     if(pointsNum  <= 0)
         QMessageBox::warning(this, tr("Error"),tr("Step value for the \"t\" parameter is not compatible with the entered range, in parametric equation") + " (P<sub>" + QString::number(index) + "</sub>).");
 
-    else if(pointsNum  > 20000)
+    else if(!adaptive && pointsNum  > 20000)
         QMessageBox::warning(this, tr("Error"), tr("Too many points to calculate on parametric equation") + " (P<sub>" + QString::number(index) + "</sub>).");
 
 }
@@ -553,8 +563,13 @@ ColorSaver* ParEqWidget::getColorSaver()
 
 void ParEqWidget::calculatePointsList()
 {
-    int numDraws = 1, end;
-    double k = kRange.start, t = 0, tStep = 0, tRatio = 1;
+    // every curve is computed on a worker thread and shown as soon as it is ready, the previous
+    // curves stay in place until then
+
+    cancelPointsComputation();
+
+    int numDraws = 1;
+    double k = kRange.start, tRatio = 1;
 
     if(tWidget->isAnimateChecked() && ratio < 1)
         tRatio = ratio;
@@ -562,37 +577,252 @@ void ParEqWidget::calculatePointsList()
     if(!kWidget->isAnimateChecked())
         numDraws = curvesNum_original;
 
-    pointsList.clear();
+    // animations step through uniformly sampled points
+    ParEqSampling curveSampling = sampling;
+    if(isAnimated())
+        curveSampling.view.reset();
 
-    Point point;
+    QList<double> kValues;
+    QList<Range> tRanges;
 
     for(int draw = 0; draw < numDraws && draw < PAR_DRAW_LIMIT; draw++)
     {
-        QList<Point> list;
-        calculator->setK(k);
         updateTRange(k);
 
         if(!isTRangeGood)
-            return;
+            break;
+
+        Range t_range = tRange;
+        t_range.step *= tRatio;
+
+        kValues << k;
+        tRanges << t_range;
+
+        k += kRange.step;
+    }
+
+    while(pointsList.size() > kValues.size())
+        pointsList.removeLast();
+    while(pointsList.size() < kValues.size())
+        pointsList << QList<Point>();
+
+    pointsRevision++;
+    pendingCurvesNum = kValues.size();
+
+    int gen = pointsGeneration.load();
+    FastTree *x_tree = xTree, *y_tree = yTree;
+    QList<FuncCalculator*> funcs = funcCalcs;
 
-        tStep = tRange.step * tRatio;
-        end = trunc((tRange.end - tRange.start)/tStep) + 1;
-        t = tRange.start;
+    for(int curve = 0 ; curve < kValues.size() ; curve++)
+    {
+        double curveK = kValues[curve];
+        Range t_range = tRanges[curve];
+
+        QFutureWatcher< QList<Point> > *watcher = new QFutureWatcher< QList<Point> >(this);
+        curveWatchers << watcher;
+
+        connect(watcher, &QFutureWatcher< QList<Point> >::finished, this, [this, watcher, curve, gen]()
+        {
+            curveComputed(watcher, curve, gen);
+        });
 
-        for(int i = 0 ; i < end ; i++)
+        watcher->setFuture(QtConcurrent::run([this, x_tree, y_tree, funcs, curveK, t_range, curveSampling, gen]()
         {
-            point.x = calculator->calculateFromTree(xTree, t);
-            point.y = calculator->calculateFromTree(yTree, t);
+            if(pointsGeneration.load() != gen)
+                return QList<Point>();
+
+            QReadLocker treesLocker(FuncCalculator::getTreesLock());
+            ExprCalculator calc(true, funcs);
+
+            return sampleCurve(x_tree, y_tree, calc, curveK, t_range, curveSampling, &pointsGeneration, gen);
+        }));
+    }
+}
+
+void ParEqWidget::curveComputed(QFutureWatcher< QList<Point> > *watcher, int curve, int gen)
+{
+    curveWatchers.removeOne(watcher);
+    watcher->deleteLater();
+
+    if(gen != pointsGeneration.load())
+        return;
+
+    pointsList[curve] = watcher->result();
+    pointsRevision++;
+    pendingCurvesNum--;
+
+    if(pendingCurvesNum == 0 && polygonResetPending)
+    {
+        polygonResetPending = false;
+        resetCurrentPolygon();
+    }
+
+    emit updateRequest();
+}
+
+void ParEqWidget::cancelPointsComputation()
+{
+    // waits for the running workers, they use the expression trees, but they give up on their own
+    // as soon as they see the generation change
+
+    pointsGeneration.ref();
+
+    for(QFutureWatcher< QList<Point> > *watcher : curveWatchers)
+    {
+        watcher->disconnect(this);
+        watcher->waitForFinished();
+        delete watcher;
+    }
+
+    curveWatchers.clear();
+    pendingCurvesNum = 0;
+}
+
+void ParEqWidget::resetCurrentPolygon()
+{
+    currentPolygon.clear();
+
+    if(tWidget->isAnimateChecked())
+        for(short i = 0 ; i < pointsList.size(); i++)
+            currentPolygon << pointsList[i].mid(0, 1);
+
+    else if(kWidget->isAnimateChecked() && !pointsList.isEmpty())
+        currentPolygon << pointsList[0];
+}
+
+bool ParEqWidget::setViewMapping(double xUnit, double yUnit, const ZeGraphView &view)
+{
+    double xRatio = xUnit / sampling.xUnit, yRatio = yUnit / sampling.yUnit;
+
+    bool rescaled = sampling.view.isNull() ||
+            xRatio > PAREQ_RESAMPLE_SCALE_RATIO || xRatio < 1 / PAREQ_RESAMPLE_SCALE_RATIO ||
+            yRatio > PAREQ_RESAMPLE_SCALE_RATIO || yRatio < 1 / PAREQ_RESAMPLE_SCALE_RATIO;
+
+    if(!rescaled)
+        return false;
+
+    sampling.xUnit = xUnit;
+    sampling.yUnit = yUnit;
+    sampling.view = QSharedPointer<const ZeGraphView>(new ZeGraphView(view));
+
+    if(!valid || isAnimated())
+        return false;
+
+    calculatePointsList();
+    return true;
+}
+
+bool ParEqWidget::needsSubdivision(Point a, Point mid, Point b, const ParEqSampling &sampling)
+{
+    const ZeGraphView &view = *sampling.view;
+
+    QPointF pa(view.unitToViewX(a.x) * sampling.xUnit, view.unitToViewY(a.y) * sampling.yUnit);
+    QPointF pm(view.unitToViewX(mid.x) * sampling.xUnit, view.unitToViewY(mid.y) * sampling.yUnit);
+    QPointF pb(view.unitToViewX(b.x) * sampling.xUnit, view.unitToViewY(b.y) * sampling.yUnit);
+
+    bool finiteA = std::isfinite(pa.x()) && std::isfinite(pa.y());
+    bool finiteM = std::isfinite(pm.x()) && std::isfinite(pm.y());
+    bool finiteB = std::isfinite(pb.x()) && std::isfinite(pb.y());
+
+    if(!finiteA || !finiteM || !finiteB) // narrows down where the curve stops being defined
+        return finiteA || finiteM || finiteB;
+
+    QPointF u = pm - pa, v = pb - pm;
+    double length = hypot(u.x(), u.y()) + hypot(v.x(), v.y());
+
+    if(length < PAREQ_MIN_SEGMENT_PX)
+        return false;
+    if(length > PAREQ_MAX_SEGMENT_PX)
+        return true;
+
+    double turn = atan2(u.x() * v.y() - u.y() * v.x(), u.x() * v.x() + u.y() * v.y());
+
+    return fabs(turn) > PAREQ_MAX_TURN_ANGLE;
+}
+
+QList<Point> ParEqWidget::sampleCurve(FastTree *x_tree, FastTree *y_tree, ExprCalculator &calc, double k, Range t_range,
+                                      const ParEqSampling &sampling, const QAtomicInt *generation, int gen)
+{
+    double pointsNum = trunc((t_range.end - t_range.start)/t_range.step) + 1;
+
+    if(sampling.view.isNull() || pointsNum <= PAREQ_SEED_POINTS)
+        return ParEqFrameCache::computeFrame(x_tree, y_tree, calc, k, t_range, generation, gen);
+
+    // the user's t step is the finest resolution: the sampling starts from a coarser uniform grid and
+    // bisects, pass after pass, the segments that are long or turn sharply on screen
 
-            list << point;
+    calc.setK(k);
 
-            t += tStep;
+    double tEnd = t_range.start + (pointsNum - 1) * t_range.step;
+    double seedStep = (tEnd - t_range.start) / (PAREQ_SEED_POINTS - 1);
+
+    QVector<double> ts, newTs;
+    QVector<Point> points, newPoints;
+    QVector<bool> toSplit, newToSplit; // per segment
+    Point point;
+
+    for(int i = 0 ; i < PAREQ_SEED_POINTS ; i++)
+    {
+        if(generation != nullptr && generation->load() != gen)
+            return QList<Point>();
+
+        double t = i == PAREQ_SEED_POINTS - 1 ? tEnd : t_range.start + i * seedStep;
+
+        point.x = calc.calculateFromTree(x_tree, t);
+        point.y = calc.calculateFromTree(y_tree, t);
+
+        ts << t;
+        points << point;
+    }
+
+    toSplit.fill(true, PAREQ_SEED_POINTS - 1);
+
+    while(toSplit.contains(true) && points.size() < PAREQ_POINTS_BUDGET)
+    {
+        if(generation != nullptr && generation->load() != gen)
+            return QList<Point>();
+
+        int size = points.size();
+
+        newTs.clear();
+        newPoints.clear();
+        newToSplit.clear();
+
+        for(int i = 0 ; i < ts.size() - 1 ; i++)
+        {
+            newTs << ts[i];
+            newPoints << points[i];
+
+            if(!toSplit[i] || size >= PAREQ_POINTS_BUDGET || ts[i+1] - ts[i] < 2 * t_range.step)
+            {
+                newToSplit << false;
+                continue;
+            }
+
+            double t = (ts[i] + ts[i+1]) / 2;
+
+            point.x = calc.calculateFromTree(x_tree, t);
+            point.y = calc.calculateFromTree(y_tree, t);
+
+            if(needsSubdivision(points[i], point, points[i+1], sampling))
+            {
+                newTs << t;
+                newPoints << point;
+                newToSplit << true << true;
+                size++;
+            }
+            else newToSplit << false;
         }
 
-        pointsList << list;
+        newTs << ts.last();
+        newPoints << points.last();
 
-        k += kRange.step;
+        ts.swap(newTs);
+        points.swap(newPoints);
+        toSplit.swap(newToSplit);
     }
+
+    return points.toList();
 }
 
 void ParEqWidget::updateAnimationSlider()
@@ -695,28 +925,73 @@ void ParEqWidget::nextFrameKchecked()
     if(!isTRangeGood)
         return;
 
+    ParEqFrameKey key = getFrameKey(current_kPos, current_k, tRange);
+    QList<Point> frame;
+
+    if(!frameCache.getFrame(key, frame))
+    {
+        frame = ParEqFrameCache::computeFrame(xTree, yTree, *calculator, current_k, tRange);
+        frameCache.addFrame(key, frame);
+    }
+
     currentPolygon.clear();
-    currentPolygon << QList<Point>();
+    currentPolygon << frame;
 
+    prefetchKFrames();
 
-    calculator->setK(current_k);
+    parCurrentValLineEdit->setText(QString::number(current_k, 'g', NUM_PREC));
+    parSlider->setValue(current_kPos);
+}
 
-    double t = tRange.start;
-    int end = trunc((tRange.end - tRange.start)/tRange.step)+ 1;
-    Point point;
+ParEqFrameKey ParEqWidget::getFrameKey(int kPos, double k, Range t_range)
+{
+    ParEqFrameKey key;
+
+    key.exprHash = qHash(xExpr) ^ (31 * qHash(yExpr));
+    key.kPos = kPos;
+    key.treesRevision = FuncCalculator::getTreesRevision();
+    key.k = k;
+    key.tStart = t_range.start;
+    key.tEnd = t_range.end;
+    key.tStep = t_range.step;
 
-    for(int i = 0 ; i < end ; i++)
+    return key;
+}
+
+void ParEqWidget::prefetchKFrames()
+{
+    if(!valid || blockAnimation || !kWidget->isAnimateChecked())
+        return;
+
+    // follows the playback direction, bouncing or wrapping like nextFrameKchecked() does
+    int kPos = current_kPos;
+    short inc = increment;
+
+    for(int i = 0 ; i < KFRAMES_PREFETCH ; i++)
     {
-        point.x = calculator->calculateFromTree(xTree, t);
-        point.y = calculator->calculateFromTree(yTree, t);
+        if((kPos <= 0 && inc < 0) || (kPos >= curvesNum_current - 1 && inc > 0))
+        {
+            if(loopRound->isChecked())
+                inc = - inc;
+            else if(loopFromStart->isChecked())
+            {
+                kPos = -1;
+                inc = 1;
+            }
+            else break;
+        }
 
-        currentPolygon[0] << point;
+        kPos += inc;
 
-        t += tRange.step;
-    }
+        double k = kRange.start + (double)(kPos) * kRange.step * ratio;
+        Range t_range = tWidget->getRange(k);
+        double pointsNum = trunc((t_range.end - t_range.start)/t_range.step) + 1;
 
-    parCurrentValLineEdit->setText(QString::number(current_k, 'g', NUM_PREC));
-    parSlider->setValue(current_kPos);
+        if(!tWidget->isValid() || pointsNum <= 0 || pointsNum >= 20000)
+            break;
+
+        frameCache.prefetch(getFrameKey(kPos, k, t_range), xTree, yTree, funcCalcs, t_range);
+    }
 }
 
 int ParEqWidget::getCurrentKPos()
@@ -729,6 +1004,11 @@ int ParEqWidget::getCurrentTPos()
     return current_pos;
 }
 
+int ParEqWidget::getPointsRevision()
+{
+    return pointsRevision;
+}
+
 bool ParEqWidget::is_t_Animated()
 {
     return tWidget->isAnimateChecked();
@@ -768,6 +1048,7 @@ void ParEqWidget::playButtonClicked()
     else
     {       
         play->setIcon(QIcon(":/icons/pause.png"));       
+        prefetchKFrames();
     }
 
     playState = !playState;
@@ -775,6 +1056,9 @@ void ParEqWidget::playButtonClicked()
 
 ParEqWidget::~ParEqWidget()
 {
+    frameCache.cancel();
+    cancelPointsComputation();
+
     if(xTree != nullptr)
         treeCreator.deleteFastTree(xTree);
     if(yTree != nullptr)
@@ -32,6 +32,21 @@
 #include "Calculus/exprcalculator.h"
 #include "Widgets/qcolorbutton.h"
 #include "Calculus/colorsaver.h"
+#include "Calculus/pareqframecache.h"
+#include "GraphDraw/graphview.h"
+
+#define PAREQ_SEED_POINTS 128 // uniform samples the adaptive sampling starts from
+#define PAREQ_POINTS_BUDGET 8000 // max points of an adaptively sampled curve
+#define PAREQ_MAX_SEGMENT_PX 12 // longer segments get subdivided
+#define PAREQ_MIN_SEGMENT_PX 0.5 // shorter segments never get subdivided
+#define PAREQ_MAX_TURN_ANGLE 0.1 // in radians, sharper turns get subdivided
+#define PAREQ_RESAMPLE_SCALE_RATIO 1.25 // zooming past this ratio resamples the curves
+
+struct ParEqSampling
+{
+    double xUnit, yUnit; // pixels per view unit
+    QSharedPointer<const ZeGraphView> view; // null until the graph is shown: uniform sampling
+};
 
 class ParEqWidget : public QWidget
 {
@@ -42,6 +57,7 @@ public:
 
     int getCurrentKPos();
     int getCurrentTPos();
+    int getPointsRevision();
 
     bool is_t_Animated();
     bool isAnimated();
@@ -55,6 +71,10 @@ public:
     void changeID(int newID);
     void nextFrame();
     void setRatio(double r);
+    bool setViewMapping(double xUnit, double yUnit, const ZeGraphView &view);
+
+    static QList<Point> sampleCurve(FastTree *x_tree, FastTree *y_tree, ExprCalculator &calc, double k, Range t_range,
+                                    const ParEqSampling &sampling, const QAtomicInt *generation = nullptr, int gen = 0);
 
     ColorSaver* getColorSaver();
 
@@ -92,10 +112,16 @@ protected:
     void addKConfWidgets();
     void addAnimationControllWidgets();
     bool areIdentical(Range a, Range b);   
+    static bool needsSubdivision(Point a, Point mid, Point b, const ParEqSampling &sampling);
     void updateAnimationSlider();
     void calculatePointsList();   
+    void curveComputed(QFutureWatcher< QList<Point> > *watcher, int curve, int gen);
+    void cancelPointsComputation();
+    void resetCurrentPolygon();
     void nextFrameTchecked();
     void nextFrameKchecked();
+    void prefetchKFrames();
+    ParEqFrameKey getFrameKey(int kPos, double k, Range t_range);
 
     void checkXline();
     void checkYline();
@@ -117,9 +143,16 @@ protected:
     TreeCreator treeCreator;
     ExprCalculator *calculator;
     ColorSaver colorSaver;
+    ParEqFrameCache frameCache;
+    ParEqSampling sampling;
     QColorButton *lastColorButton;
     QPalette validPalette, invalidPalette;
 
+    int pointsRevision; // changes every time a curve of pointsList is computed again
+    int pendingCurvesNum;
+    QAtomicInt pointsGeneration; // the workers of an outdated computation give up, and their curves are dropped
+    QList< QFutureWatcher< QList<Point> >* > curveWatchers;
+    bool polygonResetPending; // currentPolygon gets its first frame once every curve is computed
     int index, curvesNum_original, curvesNum_current, current_tPos, current_pos, current_kPos, tPos_end;
 
     bool valid, playState, is_t_range_parametric, are_expr_parametric,
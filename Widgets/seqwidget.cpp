@@ -43,6 +43,7 @@ SeqWidget::SeqWidget(QChar name, int id, QColor color) : colorSaver(color)
     connect(colorButton, SIGNAL(colorChanged(QColor)), &colorSaver, SLOT(setFristColor(QColor)));
     connect(secondColorButton, SIGNAL(colorChanged(QColor)), &colorSaver, SLOT(setLastColor(QColor)));
     connect(drawCheckBox, SIGNAL(toggled(bool)), calculator, SLOT(setDrawState(bool)));
+    connect(calculator, SIGNAL(checkpointsExtended()), this, SIGNAL(drawStateChanged()));
 
     areFirstValsParametric = areCalledFuncsSeqsParametric = isExprParametric = false;
 
@@ -94,6 +95,25 @@ SeqCalculator* SeqWidget::getCalculator()
     return calculator;
 }
 
+bool SeqWidget::event(QEvent *event)
+{
+    // the tooltip reports the memory taken by the stored terms, computed when it shows up
+
+    if(event->type() != QEvent::ToolTip)
+        return AbstractFuncWidget::event(event);
+
+    double mb = 1024 * 1024;
+
+    QString status = tr("Terms stored for this sequence: %1 MB").arg(double(calculator->getMemoryUsage()) / mb, 0, 'f', 1) + "\n" +
+            tr("All the sequences: %1 MB out of %2 MB").arg(double(SeqTermStore::getTotalMemoryUsage()) / mb, 0, 'f', 1)
+                                                      .arg(double(SeqTermStore::getMemoryBudget()) / mb, 0, 'f', 0) + "\n" +
+            tr("Rows evicted to stay within the budget: %1").arg(SeqTermStore::getEvictedRowsNum());
+
+    QToolTip::showText(static_cast<QHelpEvent*>(event)->globalPos(), status, this);
+
+    return true;
+}
+
 void SeqWidget::checkExprLineEdit()
 {
     expressionLineEdit->setNeutral();
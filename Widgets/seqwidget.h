@@ -60,6 +60,7 @@ signals:
     void newParametricState();
     
 protected:
+    bool event(QEvent *event);
     void addSeqWidgets();
     void updateParametricState();
 
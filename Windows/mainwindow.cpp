@@ -190,6 +190,8 @@ void MainWindow::makeConnects()
 {
     connect(gridButton, SIGNAL(triggered(bool)), information, SLOT(setGridState(bool)));
     connect(inputWin, SIGNAL(displayKeyboard()), keyboard, SLOT(show()));
+    connect(mainGraph, SIGNAL(framesDropped(int)), this, SLOT(showDroppedFrames(int)));
+    connect(mainGraph, SIGNAL(curvesDropped(int)), this, SLOT(showDroppedCurves(int)));
 }
 
 void MainWindow::updateGridButtonIcon()
@@ -208,6 +210,17 @@ void MainWindow::showAboutQtWin()
     QMessageBox::aboutQt(this);
 }
 
+void MainWindow::showDroppedFrames(int total)
+{
+    statusBar()->showMessage(tr("The graph takes longer to draw than the screen refresh interval: %1 frames dropped so far.").arg(total), 3000);
+}
+
+void MainWindow::showDroppedCurves(int total)
+{
+    statusBar()->showMessage(tr("%1 function curve(s) not drawn, they don't fit in the curves' memory budget "
+                                "(\"graph/curves/memory_budget_mb\" setting).").arg(total), 5000);
+}
+
 void MainWindow::closeEvent(QCloseEvent *evenement)
 {
     /* Save windows geometry */
@@ -47,6 +47,8 @@ public:
 
 protected slots:
     void showAboutQtWin();
+    void showDroppedFrames(int total);
+    void showDroppedCurves(int total);
 
 protected:
     void closeEvent(QCloseEvent *evenement);
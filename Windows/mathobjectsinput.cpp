@@ -99,7 +99,7 @@ void MathObjectsInput::addFunctions()
         else widget = new FuncWidget(funcNames[i], i, information->getGraphSettings().defaultColor);
 
         connect(widget, SIGNAL(returnPressed()), this, SLOT(draw()));
-        connect(widget, SIGNAL(drawStateChanged()), information, SLOT(emitDrawStateUpdate()));
+        connect(widget, SIGNAL(drawStateChanged()), information, SLOT(emitFuncsDrawStateUpdate()));
         connect(widget, SIGNAL(newParametricState(int)), this, SLOT(newFuncParametricState()));
 
         ui->funcWidgetsLayout->addWidget(widget);
@@ -141,7 +141,7 @@ void MathObjectsInput::addSequences()
         else widget = new SeqWidget(seqNames[i], i, information->getGraphSettings().defaultColor);
 
         connect(widget, SIGNAL(returnPressed()), this, SLOT(draw()));
-        connect(widget, SIGNAL(drawStateChanged()), information, SLOT(emitDrawStateUpdate()));
+        connect(widget, SIGNAL(drawStateChanged()), information, SLOT(emitSeqsDrawStateUpdate()));
         connect(widget, SIGNAL(newParametricState()), this, SLOT(newSeqParametricState()));
 
         ui->seqWidgetsLayout->addWidget(widget);
@@ -251,7 +251,7 @@ void MathObjectsInput::addTangent()
 
     connect(tangent, SIGNAL(removeMe(TangentWidget*)), this, SLOT(removeTangent(TangentWidget*)));
     connect(tangent, SIGNAL(returnPressed()), this, SLOT(draw()));
-    connect(tangent, SIGNAL(drawStateChanged()), information, SLOT(emitDrawStateUpdate()));
+    connect(tangent, SIGNAL(drawStateChanged()), information, SLOT(emitLinesDrawStateUpdate()));
 
     ui->linesLayout->addWidget(tangent);
 }
@@ -275,7 +275,7 @@ void MathObjectsInput::addStraightline()
 
     connect(line, SIGNAL(removeMe(StraightLineWidget*)), this, SLOT(removeStraightline(StraightLineWidget*)));
     connect(line, SIGNAL(returnPressed()), this, SLOT(draw()));
-    connect(line, SIGNAL(drawStateChanged()), information, SLOT(emitDrawStateUpdate()));
+    connect(line, SIGNAL(drawStateChanged()), information, SLOT(emitLinesDrawStateUpdate()));
 
     ui->linesLayout->addWidget(line);
 }
@@ -295,7 +295,7 @@ void MathObjectsInput::addParEq()
 {
     ParEqWidget *widget = new ParEqWidget(parEqWidgets.size(), funcCalcs, information->getGraphSettings().defaultColor);
     connect(widget, SIGNAL(removeClicked(ParEqWidget*)), this, SLOT(removeParEq(ParEqWidget*)));
-    connect(widget, SIGNAL(updateRequest()), information, SLOT(emitDrawStateUpdate()));
+    connect(widget, SIGNAL(updateRequest()), information, SLOT(emitParEqsDrawStateUpdate()));
     connect(widget, SIGNAL(animationUpdateRequest()), information, SLOT(emitAnimationUpdate()));
     connect(widget, SIGNAL(returnPressed()), this, SLOT(draw()));
 
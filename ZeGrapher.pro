@@ -5,7 +5,7 @@
 #-------------------------------------------------
 
 
-QT += widgets network svg
+QT += widgets network svg concurrent
 
 OUTPUT += Console
 
@@ -45,6 +45,13 @@ SOURCES += \
     GraphDraw/maingraph.cpp \
     GraphDraw/imagepreview.cpp \
     GraphDraw/graphdraw.cpp \
+    GraphDraw/ticklabelcache.cpp \
+    GraphDraw/framescheduler.cpp \
+    GraphDraw/geometryindex.cpp \
+    GraphDraw/datalinelod.cpp \
+    GraphDraw/densitymap.cpp \
+    GraphDraw/markersprites.cpp \
+    GraphDraw/tiledrasterizer.cpp \
     DataPlot/rowselectorwidget.cpp \
     DataPlot/rowactionswidget.cpp \
     DataPlot/datawindow.cpp \
@@ -53,7 +60,10 @@ SOURCES += \
     DataPlot/columnactionswidget.cpp \
     Calculus/treecreator.cpp \
     Calculus/seqcalculator.cpp \
+    Calculus/seqtermstore.cpp \
     Calculus/funcvaluessaver.cpp \
+    Calculus/pareqframecache.cpp \
+    Calculus/compactcurve.cpp \
     Calculus/funccalculator.cpp \
     Calculus/exprcalculator.cpp \
     Calculus/colorsaver.cpp \
@@ -103,6 +113,13 @@ HEADERS  += \
     GraphDraw/maingraph.h \
     GraphDraw/imagepreview.h \
     GraphDraw/graphdraw.h \
+    GraphDraw/ticklabelcache.h \
+    GraphDraw/framescheduler.h \
+    GraphDraw/geometryindex.h \
+    GraphDraw/datalinelod.h \
+    GraphDraw/densitymap.h \
+    GraphDraw/markersprites.h \
+    GraphDraw/tiledrasterizer.h \
     DataPlot/rowselectorwidget.h \
     DataPlot/rowactionswidget.h \
     DataPlot/datawindow.h \
@@ -112,7 +129,10 @@ HEADERS  += \
     Calculus/treecreator.h \
     Calculus/seqcolorssaver.h \
     Calculus/seqcalculator.h \
+    Calculus/seqtermstore.h \
     Calculus/funcvaluessaver.h \
+    Calculus/pareqframecache.h \
+    Calculus/compactcurve.h \
     Calculus/funccalculator.h \
     Calculus/exprcalculator.h \
     Calculus/colorsaver.h \
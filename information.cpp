@@ -22,7 +22,7 @@
 
 Information::Information()
 {
-
+    dataRevisionsCounter = 0;
 }
 
 void Information::emitDataUpdate()
@@ -33,6 +33,7 @@ void Information::emitDataUpdate()
 void Information::addDataList()
 {
     data << QList<QPointF>();
+    dataRevisions << ++dataRevisionsCounter;
 
     DataStyle style;
     dataStyle << style;
@@ -41,6 +42,7 @@ void Information::addDataList()
 void Information::removeDataList(int index)
 {
     data.removeAt(index);
+    dataRevisions.removeAt(index);
     dataStyle.removeAt(index);
     emit updateOccured();
 }
@@ -54,9 +56,16 @@ void Information::setDataStyle(int index, DataStyle style)
 void Information::setData(int index, QList<QPointF> list)
 {
     data[index] = list;
+    dataRevisions[index] = ++dataRevisionsCounter;
     emit dataUpdated();
 }
 
+int Information::getDataRevision(int index)
+{
+    // unique to the content of a data list, caches built from a list compare it to know if they are outdated
+    return dataRevisions[index];
+}
+
 int Information::getDataListsCount()
 {
     return data.size();
@@ -200,6 +209,32 @@ void Information::emitDrawStateUpdate()
     emit drawStateUpdateOccured();
 }
 
+// the typed variants let the graph redraw only the layer of the object that changed
+
+void Information::emitFuncsDrawStateUpdate()
+{
+    emit funcsDrawStateChanged();
+    emit drawStateUpdateOccured();
+}
+
+void Information::emitSeqsDrawStateUpdate()
+{
+    emit seqsDrawStateChanged();
+    emit drawStateUpdateOccured();
+}
+
+void Information::emitLinesDrawStateUpdate()
+{
+    emit linesDrawStateChanged();
+    emit drawStateUpdateOccured();
+}
+
+void Information::emitParEqsDrawStateUpdate()
+{
+    emit parEqsDrawStateChanged();
+    emit drawStateUpdateOccured();
+}
+
 const ZeViewSettings& Information::getViewSettings()
 {
     return viewSettings;
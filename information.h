@@ -47,6 +47,7 @@ public:
 
     int getDataListsCount();
     QList<QPointF> getDataList(int index);
+    int getDataRevision(int index);
     DataStyle getDataStyle(int index);
 
     void addDataRegression(Regression *reg);
@@ -82,6 +83,10 @@ signals:
     void gridStateChange();
     void updateOccured();
     void drawStateUpdateOccured();
+    void funcsDrawStateChanged();
+    void seqsDrawStateChanged();
+    void linesDrawStateChanged();
+    void parEqsDrawStateChanged();
     void animationUpdate();
     void regressionAdded(Regression *reg);
     void regressionRemoved(Regression *reg);
@@ -91,6 +96,10 @@ public slots:
     void emitUpdateSignal();
     void emitDataUpdate();
     void emitDrawStateUpdate();
+    void emitFuncsDrawStateUpdate();
+    void emitSeqsDrawStateUpdate();
+    void emitLinesDrawStateUpdate();
+    void emitParEqsDrawStateUpdate();
     void emitAnimationUpdate();
 
     void setGraphRange(const GraphRange &range);
@@ -103,6 +112,8 @@ protected:
 
     QList<QList<QPointF> > data;
     QList<DataStyle> dataStyle;
+    QList<int> dataRevisions;
+    int dataRevisionsCounter;
 
     QList<Regression*> regressions;
 
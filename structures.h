@@ -41,6 +41,7 @@
 #define INIT_FREQ 30 //animation update frequency
 #define INIT_INCR_PERIOD 100 //animation incremental period
 #define PAR_DRAW_LIMIT 500
+#define FUNC_PAR_DRAW_LIMIT 2000 // function families are evaluated for all their k values in a single sweep
 
 #define INVALID_COLOR "#FF9980"
 #define VALID_COLOR "#B2FFB2"